@@ -1,14 +1,171 @@
 #include "../../model/model_CPP/api/slitherlink.hpp"
 
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
 #ifndef GENERATE_PUZZLE_H
 #define GENERATE_PUZZLE_H
 
+typedef enum clue_removal_order {
+    CLUE_REMOVAL_RANDOM,
+    CLUE_REMOVAL_SYMMETRIC,
+    CLUE_REMOVAL_ORDERED
+} clue_removal_order;
+
+/**
+ * Version of generation algorithms, puzzles regenerated from seed
+ * are the same only for the same version. Increase it on every change
+ * of what generator draws or how it uses the draws.
+ */
+#define GENERATOR_VERSION   (1)
+
+/**
+ * Everything puzzle is regenerated from, stored instead of the puzzle.
+ */
+typedef struct puzzle_seed {
+    std::ptrdiff_t version;
+    std::ptrdiff_t size;
+    std::uint64_t seed;
+    bool minimal;
+    clue_removal_order order;
+} puzzle_seed;
+
+/**
+ * Random generator kept for whole thread, seeded from random device
+ * until seedRng() is called.
+ */
+std::mt19937* getRng();
+
+/**
+ * Seed generator of calling thread, std::seed_seq and std::mt19937
+ * give the same sequence on every platform.
+ */
+void seedRng(std::uint64_t seed);
+
+/**
+ * Uniform number from [0, n) by rejection sampling. Unlike
+ * std::uniform_int_distribution it is the same on every platform.
+ */
+std::ptrdiff_t getRandomIndex(std::mt19937* rng, std::ptrdiff_t n);
+
+/**
+ * Seed of puzzle with given index in batch generated from seed.
+ */
+std::uint64_t getPuzzleSeed(std::uint64_t seed, std::ptrdiff_t index);
+
 /**
  * Generate simple puzzle of Hexagonal type.
  * 
  */
 Slitherlink* generatePuzzleSimple(std::ptrdiff_t size);
 
+/**
+ * Fill blank puzzle with random loop and clues of all faces.
+ * Every face value and edge solution is overwritten, so puzzle can be reused.
+ */
+void fillPuzzleSimple(Slitherlink* slitherlink);
+
+/**
+ * Remove clues from puzzle while it stays uniquely solvable.
+ * Faces are tried in random order, in pairs mapped onto each other by half
+ * turn of hexagonal grid, or in given order of face ids. Clue that can't be
+ * removed stays, so the result is minimal for chosen order.
+ * Edge states of puzzle are not changed.
+ * @return number of removed clues, -1 if puzzle is not unique
+ *         or symmetric order is used on other than hexagonal grid
+ */
+std::ptrdiff_t removeClues(Slitherlink* slitherlink,
+                           clue_removal_order order,
+                           const std::vector<std::ptrdiff_t>* face_order = nullptr);
+
+/**
+ * Generate puzzle of Hexagonal type with minimal set of clues.
+ */
+Slitherlink* generatePuzzleMinimal(std::ptrdiff_t size, clue_removal_order order);
+
+/**
+ * Fill blank puzzle with random loop and minimal set of clues.
+ */
+void fillPuzzleMinimal(Slitherlink* slitherlink, clue_removal_order order);
+
+/**
+ * Change loop of uniquely solvable puzzle by local moves toward loop
+ * with given fraction of edges. Move flips one face in or out of the region
+ * inside the loop if the region stays connected and without holes, and
+ * updates shown clues of the face and its neighbours. Solver keeps its state
+ * between moves and redoes only deductions of changed clues, move that makes
+ * puzzle not unique is taken back. Hidden clues stay hidden.
+ * @return number of accepted moves, -1 if puzzle is not unique
+ *         or is not on hexagonal grid
+ */
+std::ptrdiff_t walkPuzzle(Slitherlink* slitherlink, double target_density, std::ptrdiff_t no_of_moves);
+
+/**
+ * Generate puzzle of Hexagonal type by local moves from random loop.
+ */
+Slitherlink* generatePuzzleWalk(std::ptrdiff_t size, double target_density, std::ptrdiff_t no_of_moves);
+
+/**
+ * Generate puzzle of Hexagonal type on grid too big to be built.
+ * Loop is grown on implicit grid with one byte of state per face
+ * and written as clue record, clues and edges in order of rings.
+ * @return false if writing failed
+ */
+bool generateHugePuzzle(std::ptrdiff_t size, bool with_solution, BufferedWriter* writer);
+
+/**
+ * Fill blank puzzle of the seed's size deterministically from the seed.
+ * Generator of calling thread is given back afterwards.
+ */
+void fillPuzzle(Slitherlink* slitherlink, const puzzle_seed* seed);
+
+/**
+ * Build puzzle again from its seed.
+ * @return nullptr if seed is from other version of generator
+ */
+Slitherlink* regeneratePuzzle(const puzzle_seed* seed);
+
+/**
+ * Seed as one line of text: "<version> <size> <seed> [random|symmetric|ordered]",
+ * order of clue removal is given only for minimal puzzles.
+ */
+std::string formatPuzzleSeed(const puzzle_seed* seed);
+
+/**
+ * @return false if text is not a seed written by formatPuzzleSeed
+ */
+bool parsePuzzleSeed(const std::string& text, puzzle_seed* seed);
+
+/**
+ * @return false if name is not random, symmetric or ordered
+ */
+bool getRemovalOrder(const std::string& name, clue_removal_order* order);
+
+/**
+ * Receives generated puzzle with its index, calls are serialized.
+ * Puzzle is reused after the call, so sink copies what it keeps.
+ * @return false to stop generation
+ */
+typedef std::function<bool(std::ptrdiff_t, Slitherlink*)> puzzle_sink;
+
+/**
+ * Generate count puzzles of Hexagonal type on given number of threads,
+ * 0 uses all cores. Puzzle with index i is filled from getPuzzleSeed(seed, i),
+ * so output does not depend on number of threads. Every worker fills its
+ * own copy of cached blank grid. Puzzles come to sink in order they are finished.
+ * @return number of puzzles accepted by sink
+ */
+std::ptrdiff_t generatePuzzles(std::ptrdiff_t size,
+                               std::ptrdiff_t count,
+                               std::uint64_t seed,
+                               std::ptrdiff_t threads,
+                               const puzzle_sink& sink,
+                               bool minimal = false,
+                               clue_removal_order order = CLUE_REMOVAL_RANDOM);
+
 
 
 #endif // GENERATE_PUZZLE_H
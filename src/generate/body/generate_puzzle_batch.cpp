@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "../../utilities/api/trace_lib.hpp"
+#include "../../model/model_CPP/api/topology_cache.hpp"
+#include "../api/generate_puzzle.hpp"
+
+/**
+ * State shared by workers of one batch.
+ */
+typedef struct generate_batch {
+    std::ptrdiff_t size;
+    std::ptrdiff_t count;
+    std::uint64_t seed;
+    bool minimal;
+    clue_removal_order order;
+    const puzzle_sink* sink;
+    const Slitherlink* blank;
+    std::atomic<std::ptrdiff_t> next_index;
+    std::atomic<std::ptrdiff_t> no_of_accepted;
+    std::atomic<bool> is_stopped;
+    std::mutex sink_mutex;
+} generate_batch;
+
+/**
+ * Worker takes indices until all puzzles are taken, so slow puzzles
+ * of minimal generation don't leave other threads idle.
+ */
+static void runWorker(generate_batch* batch){
+    puzzle_seed seed;
+    seed.version = GENERATOR_VERSION;
+    seed.size = batch->size;
+    seed.minimal = batch->minimal;
+    seed.order = batch->order;
+    Slitherlink* puzzle = batch->blank->copy();
+    while (!batch->is_stopped) {
+        std::ptrdiff_t index = batch->next_index++;
+        if (index >= batch->count) {
+            break;
+        }
+        seed.seed = getPuzzleSeed(batch->seed, index);
+        fillPuzzle(puzzle, &seed);
+        std::lock_guard<std::mutex> lock(batch->sink_mutex);
+        if (batch->is_stopped) {
+            break;
+        }
+        if ((*batch->sink)(index, puzzle)) {
+            batch->no_of_accepted++;
+        }
+        else {
+            LOG("Generation stopped by sink at puzzle ", index);
+            batch->is_stopped = true;
+        }
+    }
+    delete puzzle;
+}
+
+std::ptrdiff_t generatePuzzles(std::ptrdiff_t size,
+                               std::ptrdiff_t count,
+                               std::uint64_t seed,
+                               std::ptrdiff_t threads,
+                               const puzzle_sink& sink,
+                               bool minimal,
+                               clue_removal_order order){
+    if (count <= 0) {
+        return 0;
+    }
+    if (threads <= 0) {
+        threads = std::max<std::ptrdiff_t>(1, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, count);
+    generate_batch batch;
+    batch.size = size;
+    batch.count = count;
+    batch.seed = seed;
+    batch.minimal = minimal;
+    batch.order = order;
+    batch.sink = &sink;
+    batch.blank = getBlankTopology(GRID_HEXAGONAL, size);
+    batch.next_index = 0;
+    batch.no_of_accepted = 0;
+    batch.is_stopped = false;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::ptrdiff_t i = 1; i < threads; ++i) {
+        workers.emplace_back(runWorker, &batch);
+    }
+    runWorker(&batch);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return batch.no_of_accepted;
+}
@@ -0,0 +1,113 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../../utilities/api/buffered_writer.hpp"
+#include "../../utilities/api/trace_lib.hpp"
+#include "../../model/model_CPP/api/clue_format.hpp"
+#include "../../model/model_CPP/api/topology_view.hpp"
+#include "../api/generate_puzzle.hpp"
+
+/**
+ * State of face is one byte: number of accepted neighbours
+ * in lower bits and flag of face accepted into the loop.
+ */
+#define HUGE_FACE_COUNT_MASK    (0b0111)
+#define HUGE_FACE_ACCEPTED      (0b1000)
+
+/**
+ * Every face of hexagonal grid has 6 edges.
+ */
+#define HUGE_FACE_NO_OF_EDGES   (6)
+
+template<typename Function>
+static void forEachNeighbour(const HexTopology& topology, std::ptrdiff_t face_id, Function function){
+    topology.forEachFaceEdge(face_id, [&](std::ptrdiff_t edge_id){
+        std::ptrdiff_t neighbour_id = topology.getEdgeFace(edge_id, 0);
+        function(neighbour_id == face_id ? topology.getEdgeFace(edge_id, 1) : neighbour_id);
+    });
+}
+
+static void acceptFace(const HexTopology& topology,
+                       std::ptrdiff_t face_id,
+                       std::vector<std::uint8_t>* faces,
+                       std::vector<std::uint32_t>* frontier){
+    (*faces)[face_id] |= HUGE_FACE_ACCEPTED;
+    forEachNeighbour(topology, face_id, [&](std::ptrdiff_t neighbour_id){
+        if (neighbour_id == OUTER_FACE) {
+            return;
+        }
+        // count only grows, so face enters frontier at most once
+        if (++(*faces)[neighbour_id] == 1) {
+            frontier->push_back(neighbour_id);
+        }
+    });
+}
+
+/**
+ * Same growth as createRandomLoop: face with exactly one accepted
+ * neighbour is accepted, picked uniformly from the frontier. Faces that
+ * got more neighbours stay in frontier and are dropped when picked.
+ */
+static void growRegion(const HexTopology& topology, std::vector<std::uint8_t>* faces){
+    std::mt19937* rng = getRng();
+    std::vector<std::uint32_t> frontier;
+    acceptFace(topology, getRandomIndex(rng, topology.getNoOfFaces()), faces, &frontier);
+    while (!frontier.empty()) {
+        std::size_t position = getRandomIndex(rng, frontier.size());
+        std::ptrdiff_t face_id = frontier[position];
+        frontier[position] = frontier.back();
+        frontier.pop_back();
+        if ((*faces)[face_id] == 1) {
+            acceptFace(topology, face_id, faces, &frontier);
+        }
+    }
+}
+
+static bool isAccepted(const std::vector<std::uint8_t>& faces, std::ptrdiff_t face_id){
+    return face_id != OUTER_FACE && (faces[face_id] & HUGE_FACE_ACCEPTED);
+}
+
+bool generateHugePuzzle(std::ptrdiff_t size, bool with_solution, BufferedWriter* writer){
+    HexTopology topology(size);
+    std::vector<std::uint8_t> faces(topology.getNoOfFaces(), 0);
+    growRegion(topology, &faces);
+    LOG("Region grown on faces: ", faces.size());
+
+    clue_record_header header;
+    makeClueRecordHeader(size, with_solution, &header);
+    writer->write((const char*)&header, sizeof(header));
+    // edges in the loop separate accepted face from the others,
+    // so clue is number of neighbours on the other side
+    std::ptrdiff_t no_of_faces = topology.getNoOfFaces();
+    for (std::ptrdiff_t i = 0; i < no_of_faces; i += 2) {
+        char clues = 0;
+        for (std::ptrdiff_t j = i; j < i + 2 && j < no_of_faces; ++j) {
+            std::ptrdiff_t count = faces[j] & HUGE_FACE_COUNT_MASK;
+            std::ptrdiff_t value = isAccepted(faces, j) ? HUGE_FACE_NO_OF_EDGES - count : count;
+            clues |= (char)((value + 1) << (4 * (j - i)));
+        }
+        writer->write(clues);
+    }
+    if (with_solution) {
+        // rings are walked in order, so faces of edges are found without search
+        std::ptrdiff_t edge_id = 0;
+        char bits = 0;
+        for (std::ptrdiff_t ring = 0; ring < size; ++ring) {
+            for (std::ptrdiff_t index = 0; index < 18 * ring + 6; ++index, ++edge_id) {
+                if (isAccepted(faces, topology.getEdgeFace(ring, index, 0)) !=
+                    isAccepted(faces, topology.getEdgeFace(ring, index, 1))) {
+                    bits |= (char)(1 << (edge_id % 8));
+                }
+                if (edge_id % 8 == 7) {
+                    writer->write(bits);
+                    bits = 0;
+                }
+            }
+        }
+        if (edge_id % 8 != 0) {
+            writer->write(bits);
+        }
+    }
+    return writer->isGood();
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <random>
+
+#include "../../utilities/api/trace_lib.hpp"
+#include "../../model/model_CPP/api/clue_format.hpp"
+#include "../../solve/api/solver.hpp"
+#include "../api/generate_puzzle.hpp"
+
+/**
+ * Face mapped onto given face by half turn of hexagonal grid.
+ * Faces are numbered ring by ring, ring L has 6L faces starting
+ * at id 1 + 3L(L - 1), half turn moves face by 3L in its ring.
+ */
+static std::ptrdiff_t getHalfTurnFace(std::ptrdiff_t face_id){
+    if (face_id == 0) {
+        return 0;
+    }
+    std::ptrdiff_t ring = 1;
+    while (1 + 3 * ring * (ring + 1) <= face_id) {
+        ++ring;
+    }
+    std::ptrdiff_t first_face_id = 1 + 3 * ring * (ring - 1);
+    return first_face_id + (face_id - first_face_id + 3 * ring) % (6 * ring);
+}
+
+/**
+ * Split faces into groups whose clues are removed together.
+ * @return false if order can't be used for the puzzle
+ */
+static bool getFaceGroups(Slitherlink* slitherlink,
+                          clue_removal_order order,
+                          const std::vector<std::ptrdiff_t>* face_order,
+                          std::vector<std::vector<std::ptrdiff_t>>* groups){
+    std::ptrdiff_t no_of_faces = slitherlink->no_of_faces - 1;
+    if (order == CLUE_REMOVAL_ORDERED && face_order != nullptr) {
+        for (std::ptrdiff_t face_id : *face_order) {
+            if (face_id < 0 || face_id >= no_of_faces) {
+                ERROR("Face ", face_id, " is not in puzzle");
+                return false;
+            }
+            groups->push_back({face_id});
+        }
+        return true;
+    }
+    if (order == CLUE_REMOVAL_SYMMETRIC) {
+        if (getHexGridSize(slitherlink->no_of_faces) == -1) {
+            ERROR("Symmetric removal needs hexagonal grid");
+            return false;
+        }
+        for (std::ptrdiff_t i = 0; i < no_of_faces; ++i) {
+            std::ptrdiff_t pair_id = getHalfTurnFace(i);
+            if (pair_id == i) {
+                groups->push_back({i});
+            }
+            else if (i < pair_id) {
+                groups->push_back({i, pair_id});
+            }
+        }
+    }
+    else {
+        for (std::ptrdiff_t i = 0; i < no_of_faces; ++i) {
+            groups->push_back({i});
+        }
+    }
+    if (order != CLUE_REMOVAL_ORDERED) {
+        // Fisher-Yates, std::shuffle differs between standard libraries
+        std::mt19937* rng = getRng();
+        for (std::ptrdiff_t i = groups->size() - 1; i > 0; --i) {
+            std::swap((*groups)[i], (*groups)[getRandomIndex(rng, i + 1)]);
+        }
+    }
+    return true;
+}
+
+std::ptrdiff_t removeClues(Slitherlink* slitherlink,
+                           clue_removal_order order,
+                           const std::vector<std::ptrdiff_t>* face_order){
+    std::vector<std::vector<std::ptrdiff_t>> groups;
+    if (!getFaceGroups(slitherlink, order, face_order, &groups)) {
+        return -1;
+    }
+    // solver keeps propagated state between edits, known edges would be assumptions
+    Slitherlink* puzzle = slitherlink->copy();
+    puzzle->clearSolution();
+    Solver solver;
+    bool is_unique = solver.startEditing(puzzle) && solver.isUnique();
+    delete puzzle;
+    if (!is_unique) {
+        ERROR("Puzzle is not unique");
+        return -1;
+    }
+
+    std::ptrdiff_t no_of_removed = 0;
+    for (const std::vector<std::ptrdiff_t>& group : groups) {
+        std::vector<std::ptrdiff_t> removed;
+        for (std::ptrdiff_t face_id : group) {
+            if (slitherlink->faces[face_id]->value != FACE_NO_VALUE) {
+                solver.clearClue(face_id);
+                removed.push_back(face_id);
+            }
+        }
+        if (removed.empty()) {
+            continue;
+        }
+        if (solver.isUnique()) {
+            for (std::ptrdiff_t face_id : removed) {
+                slitherlink->faces[face_id]->value = FACE_NO_VALUE;
+            }
+            no_of_removed += removed.size();
+            LOG_DEBUG("Clues removed: ", removed.size());
+        }
+        else {
+            for (std::ptrdiff_t face_id : removed) {
+                solver.setClue(face_id, slitherlink->faces[face_id]->value);
+            }
+        }
+    }
+    LOG("Removed clues: ", no_of_removed);
+    return no_of_removed;
+}
+
+void fillPuzzleMinimal(Slitherlink* slitherlink, clue_removal_order order){
+    fillPuzzleSimple(slitherlink);
+    // puzzle with every clue can still have more solutions, try another loop
+    while (removeClues(slitherlink, order) == -1) {
+        fillPuzzleSimple(slitherlink);
+    }
+}
+
+Slitherlink* generatePuzzleMinimal(std::ptrdiff_t size, clue_removal_order order){
+    Slitherlink* slitherlink = new Slitherlink(size);
+    fillPuzzleMinimal(slitherlink, order);
+    return slitherlink;
+}
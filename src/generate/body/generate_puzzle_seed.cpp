@@ -0,0 +1,86 @@
+#include <sstream>
+
+#include "../../utilities/api/trace_lib.hpp"
+#include "../api/generate_puzzle.hpp"
+
+static const char* getRemovalOrderName(clue_removal_order order){
+    switch (order) {
+        case CLUE_REMOVAL_RANDOM:
+            return "random";
+        case CLUE_REMOVAL_SYMMETRIC:
+            return "symmetric";
+        case CLUE_REMOVAL_ORDERED:
+            return "ordered";
+    }
+    return "unknown";
+}
+
+bool getRemovalOrder(const std::string& name, clue_removal_order* order){
+    if (name == "random") {
+        *order = CLUE_REMOVAL_RANDOM;
+    }
+    else if (name == "symmetric") {
+        *order = CLUE_REMOVAL_SYMMETRIC;
+    }
+    else if (name == "ordered") {
+        *order = CLUE_REMOVAL_ORDERED;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void fillPuzzle(Slitherlink* slitherlink, const puzzle_seed* seed){
+    std::mt19937 previous_rng = *getRng();
+    seedRng(seed->seed);
+    if (seed->minimal) {
+        fillPuzzleMinimal(slitherlink, seed->order);
+    }
+    else {
+        fillPuzzleSimple(slitherlink);
+    }
+    *getRng() = previous_rng;
+}
+
+Slitherlink* regeneratePuzzle(const puzzle_seed* seed){
+    if (seed->version != GENERATOR_VERSION) {
+        ERROR("Seed is from generator version ", seed->version);
+        return nullptr;
+    }
+    if (seed->size <= 0) {
+        ERROR("Seed has wrong size ", seed->size);
+        return nullptr;
+    }
+    Slitherlink* slitherlink = new Slitherlink(seed->size);
+    fillPuzzle(slitherlink, seed);
+    return slitherlink;
+}
+
+std::string formatPuzzleSeed(const puzzle_seed* seed){
+    std::string text = std::to_string(seed->version) + " " +
+                       std::to_string(seed->size) + " " +
+                       std::to_string(seed->seed);
+    if (seed->minimal) {
+        text += " ";
+        text += getRemovalOrderName(seed->order);
+    }
+    return text;
+}
+
+bool parsePuzzleSeed(const std::string& text, puzzle_seed* seed){
+    std::istringstream stream(text);
+    if (!(stream >> seed->version >> seed->size >> seed->seed)) {
+        return false;
+    }
+    std::string order;
+    seed->minimal = false;
+    seed->order = CLUE_REMOVAL_RANDOM;
+    if (stream >> order) {
+        seed->minimal = true;
+        if (!getRemovalOrder(order, &seed->order)) {
+            return false;
+        }
+    }
+    return !(stream >> order);
+}
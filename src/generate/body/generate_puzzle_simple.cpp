@@ -1,5 +1,4 @@
 #include <random>
-#include <ctime>
 #include <cassert>
 #include <chrono>
 
@@ -14,65 +13,124 @@
 #define EDGE_ACCEPTED 1
 #define EDGE_NOT_ACCEPTED 2
 
-std::ptrdiff_t getRandomFaceId(std::ptrdiff_t no_of_faces, std::mt19937 rng){
-
-    std::uniform_int_distribution<int> uni(0, no_of_faces - 2);
-
-    std::ptrdiff_t x = uni(rng);
-    std::ptrdiff_t r = x % (no_of_faces - 1);
-    while (x - r > (no_of_faces - 1)){
-        x = uni(rng);
-        r = x % (no_of_faces - 1);
+/**
+ * Faces that can be added to the loop, with position of every face
+ * in the list (-1 if it is not there), so that faces are added
+ * and removed in O(1).
+ */
+typedef struct face_frontier {
+    std::vector<std::ptrdiff_t> face_ids;
+    std::vector<std::ptrdiff_t> positions;
+} face_frontier;
+
+static void addToFrontier(face_frontier* frontier, std::ptrdiff_t face_id){
+    if (frontier->positions[face_id] != -1) {
+        return;
     }
+    frontier->positions[face_id] = frontier->face_ids.size();
+    frontier->face_ids.push_back(face_id);
+}
 
-    return r;
+static void removeFromFrontier(face_frontier* frontier, std::ptrdiff_t face_id){
+    std::ptrdiff_t position = frontier->positions[face_id];
+    if (position == -1) {
+        return;
+    }
+    // swap with last face and pop
+    std::ptrdiff_t last_face_id = frontier->face_ids.back();
+    frontier->face_ids[position] = last_face_id;
+    frontier->positions[last_face_id] = position;
+    frontier->face_ids.pop_back();
+    frontier->positions[face_id] = -1;
 }
 
-std::ptrdiff_t getRandomFaceFromQueue(std::vector<std::ptrdiff_t>& face_queue, std::mt19937 rng){
-    assert(face_queue.size() > 0);
+std::mt19937* getRng(){
+    thread_local std::mt19937 rng(std::random_device{}());
+    return &rng;
+}
 
-    std::uniform_int_distribution<int> uni(0, face_queue.size() - 1);
+void seedRng(std::uint64_t seed){
+    std::seed_seq seed_sequence{(std::uint32_t)seed, (std::uint32_t)(seed >> 32)};
+    getRng()->seed(seed_sequence);
+}
 
-    std::ptrdiff_t x = uni(rng);
-    std::ptrdiff_t r = x % face_queue.size();
-    while (x - r > (std::ptrdiff_t)face_queue.size()) { // realistically size of queue is never bigger then max ptrdiff_t
-        x = uni(rng);
-        r = x % face_queue.size();
+std::ptrdiff_t getRandomIndex(std::mt19937* rng, std::ptrdiff_t n){
+    assert(n > 0 && (std::uint64_t)n <= ((std::uint64_t)1 << 32));
+    // largest multiple of n that fits, values above it would favour small numbers
+    std::uint64_t range = (std::uint64_t)1 << 32;
+    std::uint64_t limit = range - range % (std::uint64_t)n;
+    std::uint64_t value = (*rng)();
+    while (value >= limit) {
+        value = (*rng)();
     }
-    std::ptrdiff_t face_id = face_queue[r];
-    face_queue.erase(face_queue.begin() + r);
+    return value % (std::uint64_t)n;
+}
 
-    LOG_DEBUG("Face taken from queue: ", face_id);
+std::uint64_t getPuzzleSeed(std::uint64_t seed, std::ptrdiff_t index){
+    // splitmix64, close seeds give unrelated puzzles
+    std::uint64_t value = seed + (std::uint64_t)(index + 1) * 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+static std::ptrdiff_t getRandomFaceFromFrontier(face_frontier* frontier, std::mt19937* rng){
+    assert(frontier->face_ids.size() > 0);
+    std::ptrdiff_t face_id = frontier->face_ids[getRandomIndex(rng, frontier->face_ids.size())];
+    removeFromFrontier(frontier, face_id);
+    LOG_DEBUG("Face taken from frontier: ", face_id);
     return face_id;
 }
 
+/**
+ * Face can be added to the loop only if exactly one of its edges is in the loop.
+ */
+static void updateFaceCount(std::ptrdiff_t face_id,
+                            std::ptrdiff_t change,
+                            face_frontier* frontier,
+                            std::vector<int>* face_indicators,
+                            std::vector<std::ptrdiff_t>* face_counts){
+    if (face_id == OUTER_FACE) {
+        return;
+    }
+    (*face_counts)[face_id] += change;
+    if ((*face_indicators)[face_id] != FACE_UNPROCESSED) {
+        return;
+    }
+    if ((*face_counts)[face_id] == 1) {
+        addToFrontier(frontier, face_id);
+    }
+    else {
+        removeFromFrontier(frontier, face_id);
+    }
+}
+
 void processAcceptedFace(Slitherlink* slitherlink,
                          std::ptrdiff_t face_id,
-                         std::vector<std::ptrdiff_t>* face_queue,
+                         face_frontier* frontier,
                          std::vector<int>* face_indicators,
-                         std::vector<int>* edge_indicators) {
+                         std::vector<int>* edge_indicators,
+                         std::vector<std::ptrdiff_t>* face_counts) {
     LOG_DEBUG("Processing accepted face: ", face_id);
     slitherlink_face* face = slitherlink->faces[face_id];
     (*face_indicators)[face_id] = FACE_ACCEPTED;
     for (std::ptrdiff_t i = 0; i < face->no_of_edges; ++i) {
         std::ptrdiff_t edge_id = face->edge_ids[i];
+        slitherlink_edge* edge = slitherlink->edges[edge_id];
+        std::ptrdiff_t new_face_id = edge->face_ids[0] == face_id ?
+                                        edge->face_ids[1] :
+                                        edge->face_ids[0];
+        assert(new_face_id != face_id);
         if ((*edge_indicators)[edge_id] == EDGE_UNPROCESSED) {
             (*edge_indicators)[edge_id] = EDGE_ACCEPTED;
-            slitherlink_edge* edge = slitherlink->edges[edge_id];
-            std::ptrdiff_t new_face_id = edge->face_ids[0] == face_id ?
-                                            edge->face_ids[1] :
-                                            edge->face_ids[0];
-            if (new_face_id == OUTER_FACE) {
-                continue;
-            }
-            assert(new_face_id != face_id);
-            LOG_DEBUG("New face id: ", new_face_id);
-            assert((*face_indicators)[new_face_id] != FACE_ACCEPTED);
-            face_queue->push_back(new_face_id);
-            LOG_DEBUG("Face added to queue: ", new_face_id);
+            (*face_counts)[face_id]++;
+            updateFaceCount(new_face_id, 1, frontier, face_indicators, face_counts);
+            LOG_DEBUG("Face counted for frontier: ", new_face_id);
         }
         else {
             (*edge_indicators)[edge_id] = EDGE_NOT_ACCEPTED;
+            (*face_counts)[face_id]--;
+            updateFaceCount(new_face_id, -1, frontier, face_indicators, face_counts);
         }
     }
 }
@@ -88,61 +146,33 @@ void logIndicators(std::vector<int>* indicators, std::string name){
     (void)name;
 }
 
-void createRandomLoop(Slitherlink* slitherlink, std::vector<int>* face_indicators, std::vector<int>* edge_indicators) {
+void createRandomLoop(Slitherlink* slitherlink,
+                      std::vector<int>* face_indicators,
+                      std::vector<int>* edge_indicators,
+                      std::vector<std::ptrdiff_t>* face_counts) {
     LOG("Creating random loop");
-    std::vector<std::ptrdiff_t> face_queue = std::vector<std::ptrdiff_t>();
-    
-    std::random_device rd;
-    std::mt19937 rng(rd());
-
-    // initialize the first face
-    std::ptrdiff_t first_face_id = getRandomFaceId(slitherlink->no_of_faces - 1, rng);
-    processAcceptedFace(slitherlink, first_face_id, &face_queue, face_indicators, edge_indicators);
-
-    // find other faces
-    while (face_queue.size() > 0) {
-        std::ptrdiff_t face_id = getRandomFaceFromQueue(face_queue, rng);
-        if ((*face_indicators)[face_id] == FACE_ACCEPTED ||
-            (*face_indicators)[face_id] == FACE_REJECTED) {
-            continue;
-        }
-        slitherlink_face* face = slitherlink->faces[face_id];
-        // check if exactly one edge is already in edge_indicators
-        std::ptrdiff_t edge_count = 0;
-        for (std::ptrdiff_t i = 0; i < face->no_of_edges; ++i) {
-            std::ptrdiff_t edge_id = face->edge_ids[i];
-            if ((*edge_indicators)[edge_id] == EDGE_ACCEPTED) {
-                edge_count++;
-            }
-        }
-
-        LOG_DEBUG("Face ", face_id, " has ", edge_count, " edge(s) in edge_indicators");
-
-        // if no edge is in edge_indicators, then how this face ended up here?
-        assert(edge_count > 0);
-
-        // if more than one edge found then we skip this face
-        if (edge_count > 1) {
-            continue;
-        }
-
-        processAcceptedFace(slitherlink, face_id, &face_queue, face_indicators, edge_indicators);
+    std::mt19937* rng = getRng();
+    face_frontier frontier;
+    frontier.positions.assign(slitherlink->no_of_faces, -1);
+
+    // initialize the first face, outer face is the last one
+    std::ptrdiff_t first_face_id = getRandomIndex(rng, slitherlink->no_of_faces - 1);
+    processAcceptedFace(slitherlink, first_face_id, &frontier, face_indicators, edge_indicators, face_counts);
+
+    // find other faces, frontier has only faces with exactly one edge in the loop
+    while (frontier.face_ids.size() > 0) {
+        std::ptrdiff_t face_id = getRandomFaceFromFrontier(&frontier, rng);
+        assert((*face_counts)[face_id] == 1);
+        processAcceptedFace(slitherlink, face_id, &frontier, face_indicators, edge_indicators, face_counts);
     }
     logIndicators(face_indicators, "Face indicators");
     logIndicators(edge_indicators, "Edge indicators");
 }
 
-void addFaceValues(Slitherlink* slitherlink, std::vector<int>* edge_indicators) {
+void addFaceValues(Slitherlink* slitherlink, std::vector<std::ptrdiff_t>* face_counts) {
     LOG("Adding face values");
     for (std::ptrdiff_t i = 0; i < slitherlink->no_of_faces - 1; ++i) {
-        std::ptrdiff_t no_of_chosen_edges = 0;
-        for (std::ptrdiff_t j = 0; j < slitherlink->faces[i]->no_of_edges; ++j) {
-            std::ptrdiff_t edge_id = slitherlink->faces[i]->edge_ids[j];
-            if ((*edge_indicators)[edge_id] == EDGE_ACCEPTED) {
-                no_of_chosen_edges++;
-            }
-        }
-        slitherlink->faces[i]->value = no_of_chosen_edges;
+        slitherlink->faces[i]->value = (*face_counts)[i];
     }
 }
 
@@ -158,19 +188,24 @@ void addEdgeValues(Slitherlink* slitherlink, std::vector<int>* edge_indicators)
     }
 }
 
-Slitherlink* generatePuzzleSimple(std::ptrdiff_t size){
-    Slitherlink* slitherlink = new Slitherlink(size);
+void fillPuzzleSimple(Slitherlink* slitherlink){
     std::vector<int> face_indicators = std::vector<int>(slitherlink->no_of_faces, FACE_UNPROCESSED);
     std::vector<int> edge_indicators = std::vector<int>(slitherlink->no_of_edges, EDGE_UNPROCESSED);
-    
+    // number of edges of every face that are in the loop
+    std::vector<std::ptrdiff_t> face_counts = std::vector<std::ptrdiff_t>(slitherlink->no_of_faces, 0);
+
     // create a random loop
-    createRandomLoop(slitherlink, &face_indicators, &edge_indicators);
+    createRandomLoop(slitherlink, &face_indicators, &edge_indicators, &face_counts);
 
     // add values to the faces
-    addFaceValues(slitherlink, &edge_indicators);
+    addFaceValues(slitherlink, &face_counts);
 
     // add values to the edges
     addEdgeValues(slitherlink, &edge_indicators);
+}
 
+Slitherlink* generatePuzzleSimple(std::ptrdiff_t size){
+    Slitherlink* slitherlink = new Slitherlink(size);
+    fillPuzzleSimple(slitherlink);
     return slitherlink;
 }
@@ -0,0 +1,192 @@
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+#include "../../utilities/api/trace_lib.hpp"
+#include "../../model/model_CPP/api/clue_format.hpp"
+#include "../../solve/api/solver.hpp"
+#include "../api/generate_puzzle.hpp"
+
+/**
+ * Clue of face whose value changed by the move, with value before it.
+ */
+typedef struct changed_clue {
+    std::ptrdiff_t face_id;
+    std::ptrdiff_t old_value;
+    std::ptrdiff_t new_value;
+} changed_clue;
+
+static bool isInLoop(const slitherlink_edge* edge){
+    return edge->solution == EDGE_IN_SOLUTION;
+}
+
+static std::ptrdiff_t getLoopEdgeCount(const slitherlink_face* face){
+    std::ptrdiff_t count = 0;
+    for (const slitherlink_edge* edge : face->edge_refs) {
+        count += isInLoop(edge) ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * Other edge of the face that meets given edge in given vertex.
+ */
+static const slitherlink_edge* getNextFaceEdge(const slitherlink_face* face,
+                                               const slitherlink_edge* edge,
+                                               const slitherlink_vertex* vertex){
+    for (const slitherlink_edge* next_edge : vertex->edge_refs) {
+        if (next_edge != edge &&
+            (next_edge->face_ids[0] == face->id || next_edge->face_ids[1] == face->id)) {
+            return next_edge;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Flipping face keeps region inside the loop connected and without holes
+ * exactly when loop edges of the face form one run, which is not the whole
+ * face. Run ends are vertices where loop edge meets edge of face outside loop.
+ * On hexagonal grid every vertex has three edges, so the loop can't touch itself.
+ */
+static bool canFlipFace(const slitherlink_face* face){
+    std::ptrdiff_t no_of_ends = 0;
+    for (const slitherlink_edge* edge : face->edge_refs) {
+        if (!isInLoop(edge)) {
+            continue;
+        }
+        for (const slitherlink_vertex* vertex : edge->vertex_refs) {
+            if (!isInLoop(getNextFaceEdge(face, edge, vertex))) {
+                no_of_ends++;
+            }
+        }
+    }
+    return no_of_ends == 2;
+}
+
+static void flipFace(slitherlink_face* face){
+    for (slitherlink_edge* edge : face->edge_refs) {
+        edge->solution = isInLoop(edge) ? EDGE_NOT_IN_SOLUTION : EDGE_IN_SOLUTION;
+    }
+}
+
+/**
+ * Shown clues of flipped face and its neighbours that no longer match the loop.
+ */
+static void getChangedClues(const Slitherlink* slitherlink,
+                            const slitherlink_face* face,
+                            std::vector<changed_clue>* changed){
+    changed->clear();
+    if (face->value != FACE_NO_VALUE && face->value != getLoopEdgeCount(face)) {
+        changed->push_back({face->id, face->value, getLoopEdgeCount(face)});
+    }
+    // neighbours share one edge with the face, so their clues always change
+    for (const slitherlink_edge* edge : face->edge_refs) {
+        std::ptrdiff_t neighbour_id = edge->face_ids[edge->face_ids[0] == face->id ? 1 : 0];
+        if (neighbour_id == OUTER_FACE) {
+            continue;
+        }
+        const slitherlink_face* neighbour = slitherlink->faces[neighbour_id];
+        if (neighbour->value != FACE_NO_VALUE) {
+            changed->push_back({neighbour_id, neighbour->value, getLoopEdgeCount(neighbour)});
+        }
+    }
+}
+
+/**
+ * Clues are cleared before any is set, so every state the solver
+ * goes through is solved by the new loop and stays consistent.
+ */
+static void editClues(Slitherlink* slitherlink,
+                      Solver* solver,
+                      const std::vector<changed_clue>& changed,
+                      bool is_undo){
+    for (const changed_clue& clue : changed) {
+        solver->clearClue(clue.face_id);
+    }
+    for (const changed_clue& clue : changed) {
+        std::ptrdiff_t value = is_undo ? clue.old_value : clue.new_value;
+        solver->setClue(clue.face_id, value);
+        slitherlink->faces[clue.face_id]->value = value;
+    }
+}
+
+/**
+ * Metropolis acceptance on distance of loop length from target,
+ * move further by d edges is taken with probability 2^-d.
+ * Powers of two keep walk the same on every platform.
+ */
+static bool acceptLength(std::ptrdiff_t old_length,
+                         std::ptrdiff_t new_length,
+                         std::ptrdiff_t target_length,
+                         std::mt19937* rng){
+    std::ptrdiff_t change = std::abs(new_length - target_length) - std::abs(old_length - target_length);
+    if (change <= 0) {
+        return true;
+    }
+    return getRandomIndex(rng, (std::ptrdiff_t)1 << change) == 0;
+}
+
+std::ptrdiff_t walkPuzzle(Slitherlink* slitherlink, double target_density, std::ptrdiff_t no_of_moves){
+    if (getHexGridSize(slitherlink->no_of_faces) == -1) {
+        ERROR("Local moves need hexagonal grid");
+        return -1;
+    }
+    // solver keeps propagated state between moves, known edges would be assumptions
+    Slitherlink* puzzle = slitherlink->copy();
+    puzzle->clearSolution();
+    Solver solver;
+    bool is_unique = solver.startEditing(puzzle) && solver.isUnique();
+    delete puzzle;
+    if (!is_unique) {
+        ERROR("Puzzle is not unique");
+        return -1;
+    }
+
+    std::ptrdiff_t loop_length = 0;
+    for (const slitherlink_edge* edge : slitherlink->edges) {
+        loop_length += isInLoop(edge) ? 1 : 0;
+    }
+    std::ptrdiff_t target_length = (std::ptrdiff_t)std::llround(target_density * slitherlink->no_of_edges);
+    std::mt19937* rng = getRng();
+    std::vector<changed_clue> changed;
+    std::ptrdiff_t no_of_accepted = 0;
+    for (std::ptrdiff_t i = 0; i < no_of_moves; ++i) {
+        slitherlink_face* face = slitherlink->faces[getRandomIndex(rng, slitherlink->no_of_faces - 1)];
+        if (!canFlipFace(face)) {
+            continue;
+        }
+        std::ptrdiff_t new_length = loop_length + face->no_of_edges - 2 * getLoopEdgeCount(face);
+        if (!acceptLength(loop_length, new_length, target_length, rng)) {
+            continue;
+        }
+        flipFace(face);
+        getChangedClues(slitherlink, face, &changed);
+        // both loops solve unchanged clues
+        if (changed.empty()) {
+            flipFace(face);
+            continue;
+        }
+        editClues(slitherlink, &solver, changed, false);
+        if (!solver.isUnique()) {
+            editClues(slitherlink, &solver, changed, true);
+            flipFace(face);
+            LOG_DEBUG("Move of face ", face->id, " is not unique");
+            continue;
+        }
+        loop_length = new_length;
+        no_of_accepted++;
+    }
+    LOG("Accepted moves: ", no_of_accepted, ", loop length: ", loop_length);
+    return no_of_accepted;
+}
+
+Slitherlink* generatePuzzleWalk(std::ptrdiff_t size, double target_density, std::ptrdiff_t no_of_moves){
+    Slitherlink* slitherlink = new Slitherlink(size);
+    fillPuzzleSimple(slitherlink);
+    // walk starts only from unique puzzle, try another loop
+    while (walkPuzzle(slitherlink, target_density, no_of_moves) == -1) {
+        fillPuzzleSimple(slitherlink);
+    }
+    return slitherlink;
+}
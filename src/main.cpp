@@ -1,9 +1,360 @@
 #include "model/model_CPP/api/slitherlink.hpp"
+#include "model/model_CPP/api/puzzle_stream.hpp"
+#include "model/model_CPP/api/importer.hpp"
+#include "model/model_CPP/api/solution_set.hpp"
 #include "generate/api/generate_puzzle.hpp"
 #include "solve/api/solver.hpp"
+#include "solve/api/verifier.hpp"
+#include "utilities/api/buffered_writer.hpp"
 #include "utilities/api/trace_lib.hpp"
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unistd.h>
 
-int main(){
+/**
+ * Options shared by pipeline modes.
+ */
+typedef struct pipeline_options {
+    puzzle_format format;
+    std::ptrdiff_t limit;
+    bool minimal;
+    clue_removal_order removal_order;
+    std::uint64_t seed;
+    std::ptrdiff_t threads;
+    bool huge;
+    bool keys;
+} pipeline_options;
+
+static void printUsage(const char* name){
+    std::fprintf(stderr,
+        "usage: %s                                    generate and solve demo puzzle\n"
+        "       %s generate <size> [count] [options] write puzzles to stdout\n"
+        "       %s solve [options]                   solve puzzles from stdin\n"
+        "       %s convert [options]                 convert puzzles from stdin\n"
+        "       %s import [options]                  import pzpr URLs or rows of clues from stdin\n"
+        "       %s enumerate <file> [options]        write solutions of puzzle from stdin to solution set\n"
+        "       %s regenerate [options]              write puzzles of seed keys from stdin\n"
+        "       %s verify                            check solutions from stdin\n"
+        "       %s verify <file>                     check solution set of puzzle from stdin\n"
+        "options: --format text|binary|clue   format of output (default text)\n"
+        "         --limit <n>                 solutions written per puzzle (default 1, all for enumerate)\n"
+        "         --minimal random|symmetric|ordered\n"
+        "                                     generate puzzles with minimal set of clues\n"
+        "         --seed <n>                  seed of generated puzzles (default random)\n"
+        "         --threads <n>               threads generating puzzles, 0 for all cores (default 1)\n"
+        "         --huge                      generate on implicit grid, written in clue format\n"
+        "         --keys                      write seed keys of puzzles instead of puzzles\n"
+        "Input can be any format. Statistics are written as comments to text output\n"
+        "and to stderr for other formats.\n",
+        name, name, name, name, name, name, name, name, name);
+}
+
+/**
+ * Parse whole argument as number.
+ * @return false if argument is not a number
+ */
+template<typename Number>
+static bool readNumber(const char* argument, Number* value){
+    const char* end = argument + std::strlen(argument);
+    std::from_chars_result result = std::from_chars(argument, end, *value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+/**
+ * Parse options starting at given argument, options keep their defaults.
+ * @return false if option is not known
+ */
+static bool readOptions(int argc, char** argv, int first, pipeline_options* options){
+    for (int i = first; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!getPuzzleFormat(argv[++i], &options->format)) {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            if (!readNumber(argv[++i], &options->limit)) {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--minimal") == 0 && i + 1 < argc) {
+            options->minimal = true;
+            if (!getRemovalOrder(argv[++i], &options->removal_order)) {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            if (!readNumber(argv[++i], &options->seed)) {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            if (!readNumber(argv[++i], &options->threads)) {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--huge") == 0) {
+            options->huge = true;
+        }
+        else if (std::strcmp(argv[i], "--keys") == 0) {
+            options->keys = true;
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Statistics line goes to text stream as comment, so it can be read back.
+ */
+static void writeStatistics(const std::string& line, const pipeline_options* options, BufferedWriter* writer){
+    if (options->format == PUZZLE_FORMAT_TEXT) {
+        writer->write("# ");
+        writer->write(line);
+        writer->write('\n');
+    }
+    else {
+        std::fprintf(stderr, "%s\n", line.c_str());
+    }
+}
+
+static int runGenerate(std::ptrdiff_t size, std::ptrdiff_t count, const pipeline_options* options){
+    BufferedWriter writer(STDOUT_FILENO);
+    if (options->keys) {
+        // key of puzzle is known without generating it
+        puzzle_seed seed{GENERATOR_VERSION, size, 0, options->minimal, options->removal_order};
+        for (std::ptrdiff_t i = 0; i < count; ++i) {
+            seed.seed = getPuzzleSeed(options->seed, i);
+            writer.write(formatPuzzleSeed(&seed));
+            writer.write('\n');
+        }
+        return writer.flush() ? 0 : 1;
+    }
+    if (options->huge) {
+        for (std::ptrdiff_t i = 0; i < count; ++i) {
+            seedRng(getPuzzleSeed(options->seed, i));
+            if (!generateHugePuzzle(size, false, &writer)) {
+                return 1;
+            }
+        }
+        return writer.flush() ? 0 : 1;
+    }
+    // puzzles finished early wait for their turn, so output is the same
+    // for any number of threads, writer flushes when its buffer is full
+    std::map<std::ptrdiff_t, Slitherlink*> pending;
+    std::ptrdiff_t next_index = 0;
+    bool is_good = true;
+    generatePuzzles(size, count, options->seed, options->threads,
+        [&](std::ptrdiff_t index, Slitherlink* puzzle) {
+            Slitherlink* copy = puzzle->copy();
+            copy->clearSolution();
+            pending[index] = copy;
+            while (is_good && !pending.empty() && pending.begin()->first == next_index) {
+                Slitherlink* next = pending.begin()->second;
+                pending.erase(pending.begin());
+                is_good = writePuzzle(next, options->format, &writer) && writer.isGood();
+                delete next;
+                ++next_index;
+            }
+            return is_good;
+        },
+        options->minimal, options->removal_order);
+    for (const auto& entry : pending) {
+        delete entry.second;
+    }
+    return writer.flush() && next_index == count ? 0 : 1;
+}
+
+/**
+ * Every line of stdin is key written by generate --keys.
+ */
+static int runRegenerate(const pipeline_options* options){
+    BufferedWriter writer(STDOUT_FILENO);
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        puzzle_seed seed;
+        if (!parsePuzzleSeed(line, &seed)) {
+            ERROR("Wrong seed key: ", line);
+            return 1;
+        }
+        Slitherlink* puzzle = regeneratePuzzle(&seed);
+        if (puzzle == nullptr) {
+            return 1;
+        }
+        puzzle->clearSolution();
+        bool result = writePuzzle(puzzle, options->format, &writer);
+        delete puzzle;
+        if (!result || !writer.isGood()) {
+            return 1;
+        }
+    }
+    return writer.flush() ? 0 : 1;
+}
+
+static int runSolve(const pipeline_options* options){
+    PuzzleStreamReader reader(STDIN_FILENO);
+    BufferedWriter writer(STDOUT_FILENO);
+    Solver solver;
+    std::ptrdiff_t i = 0;
+    while (Slitherlink* puzzle = reader.nextPuzzle()) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<Slitherlink*> solutions;
+        solver.startSolving(puzzle);
+        Slitherlink* solution = nullptr;
+        while ((std::ptrdiff_t)solutions.size() < options->limit &&
+               (solution = solver.nextSolution()) != nullptr) {
+            solutions.push_back(solution->copy());
+        }
+        // one more solution tells if puzzle is unique
+        bool is_unique = solutions.size() == 1 &&
+                         (options->limit > 1 || solver.nextSolution() == nullptr);
+        std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+        writeStatistics("puzzle " + std::to_string(i) +
+                        " vertices " + std::to_string(puzzle->no_of_vertices) +
+                        " edges " + std::to_string(puzzle->no_of_edges) +
+                        " solutions " + std::to_string(solutions.size()) +
+                        " unique " + std::to_string(is_unique) +
+                        " time_ms " + std::to_string(time.count()),
+                        options, &writer);
+        bool result = true;
+        for (Slitherlink* found : solutions) {
+            result = writePuzzle(found, options->format, &writer) && result;
+            delete found;
+        }
+        delete puzzle;
+        if (!result || !writer.flush()) {
+            return 1;
+        }
+        ++i;
+    }
+    return reader.isGood() ? 0 : 1;
+}
+
+static int runConvert(const pipeline_options* options){
+    PuzzleStreamReader reader(STDIN_FILENO);
+    BufferedWriter writer(STDOUT_FILENO);
+    while (Slitherlink* puzzle = reader.nextPuzzle()) {
+        bool result = writePuzzle(puzzle, options->format, &writer);
+        delete puzzle;
+        if (!result || !writer.flush()) {
+            return 1;
+        }
+    }
+    return reader.isGood() ? 0 : 1;
+}
+
+static int runImport(const pipeline_options* options){
+    PuzzleImporter importer(STDIN_FILENO);
+    BufferedWriter writer(STDOUT_FILENO);
+    while (Slitherlink* puzzle = importer.nextPuzzle()) {
+        bool result = writePuzzle(puzzle, options->format, &writer);
+        delete puzzle;
+        if (!result || !writer.flush()) {
+            return 1;
+        }
+    }
+    return importer.isGood() ? 0 : 1;
+}
+
+static int runEnumerate(const std::string& file_name, const pipeline_options* options){
+    PuzzleStreamReader reader(STDIN_FILENO);
+    Slitherlink* puzzle = reader.nextPuzzle();
+    if (puzzle == nullptr) {
+        return 1;
+    }
+    SolutionSetWriter writer(file_name, puzzle->no_of_edges);
+    Solver solver;
+    solver.startSolving(puzzle);
+    Slitherlink* solution = nullptr;
+    bool result = writer.isOpen();
+    while (result && writer.getNoOfSolutions() < options->limit &&
+           (solution = solver.nextSolution()) != nullptr) {
+        result = writer.append(solution);
+    }
+    std::fprintf(stderr, "solutions %td\n", writer.getNoOfSolutions());
+    delete puzzle;
+    return writer.close() && result ? 0 : 1;
+}
+
+/**
+ * Solutions are verified in batches on all cores.
+ */
+#define VERIFY_BATCH_SIZE   (256)
+
+static int runVerify(){
+    PuzzleStreamReader reader(STDIN_FILENO);
+    BufferedWriter writer(STDOUT_FILENO);
+    std::vector<Slitherlink*> batch;
+    std::vector<verification_result> results;
+    std::ptrdiff_t i = 0;
+    bool all_correct = true;
+    bool at_end = false;
+    while (!at_end) {
+        Slitherlink* solution = reader.nextPuzzle();
+        at_end = solution == nullptr;
+        if (solution != nullptr) {
+            batch.push_back(solution);
+        }
+        if ((at_end && !batch.empty()) || batch.size() == VERIFY_BATCH_SIZE) {
+            all_correct = verifySolutions(batch, &results) == (std::ptrdiff_t)batch.size() && all_correct;
+            for (std::size_t j = 0; j < batch.size(); ++j) {
+                writer.write("puzzle ");
+                writer.writeNumber(i++);
+                writer.write(' ');
+                writer.write(getVerificationName(results[j]));
+                writer.write('\n');
+                delete batch[j];
+            }
+            batch.clear();
+            writer.flush();
+        }
+    }
+    return all_correct && reader.isGood() ? 0 : 1;
+}
+
+static int runVerifySet(const std::string& file_name){
+    PuzzleStreamReader reader(STDIN_FILENO);
+    Slitherlink* puzzle = reader.nextPuzzle();
+    SolutionSetReader solutions(file_name);
+    if (puzzle == nullptr || !solutions.isOpen() || solutions.getNoOfEdges() != puzzle->no_of_edges) {
+        delete puzzle;
+        return 1;
+    }
+    BufferedWriter writer(STDOUT_FILENO);
+    std::ptrdiff_t no_of_correct = 0;
+    while (solutions.nextSolution()) {
+        verification_result result = verifySolution(puzzle, solutions.getBits());
+        if (result == VERIFICATION_CORRECT) {
+            no_of_correct++;
+            continue;
+        }
+        writer.write("solution ");
+        writer.writeNumber(solutions.getIndex());
+        writer.write(' ');
+        writer.write(getVerificationName(result));
+        writer.write('\n');
+    }
+    writer.write("correct ");
+    writer.writeNumber(no_of_correct);
+    writer.write(" of ");
+    writer.writeNumber(solutions.getNoOfSolutions());
+    writer.write('\n');
+    delete puzzle;
+    return no_of_correct == solutions.getNoOfSolutions() ? 0 : 1;
+}
+
+static void runDemo(){
     // Slitherlink puzzle = Slitherlink("test.txt");
     // puzzle.savePuzzle("test_output.txt");
     Slitherlink* puzzle = generatePuzzleSimple(5);
@@ -13,14 +364,66 @@ int main(){
     puzzle->clearSolution();
 
     Solver* solver = new Solver();
-    std::vector<Slitherlink*> slitherlink_solution;
-    solver->solvePuzzle(puzzle, &slitherlink_solution);
-    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)slitherlink_solution.size(); ++i) {
-        slitherlink_solution[i]->savePuzzle("generated_solution" + std::to_string(i) + ".txt");
+    std::ptrdiff_t i = 0;
+    for (Slitherlink& solution : solver->solutions(puzzle)) {
+        solution.savePuzzle("generated_solution" + std::to_string(i) + ".txt");
         LOG("Puzzle ", i, " solved");
-        delete slitherlink_solution[i];
+        ++i;
     }
 
     delete solver;
     delete puzzle;
-}
\ No newline at end of file
+}
+
+int main(int argc, char** argv){
+    if (argc < 2) {
+        runDemo();
+        return 0;
+    }
+    std::string mode = argv[1];
+    pipeline_options options;
+    options.format = PUZZLE_FORMAT_TEXT;
+    options.limit = 1;
+    options.minimal = false;
+    options.removal_order = CLUE_REMOVAL_RANDOM;
+    options.seed = ((std::uint64_t)std::random_device{}() << 32) | std::random_device{}();
+    options.threads = 1;
+    options.huge = false;
+    options.keys = false;
+    std::ptrdiff_t size = 0;
+    if (mode == "generate" && argc >= 3 && readNumber(argv[2], &size) && size > 0) {
+        std::ptrdiff_t count = 1;
+        int first = 3;
+        bool is_correct = true;
+        if (argc >= 4 && argv[3][0] != '-') {
+            is_correct = readNumber(argv[3], &count) && count >= 0;
+            first = 4;
+        }
+        if (is_correct && readOptions(argc, argv, first, &options)) {
+            return runGenerate(size, count, &options);
+        }
+    }
+    else if (mode == "solve" && readOptions(argc, argv, 2, &options)) {
+        return runSolve(&options);
+    }
+    else if (mode == "regenerate" && readOptions(argc, argv, 2, &options)) {
+        return runRegenerate(&options);
+    }
+    else if (mode == "convert" && readOptions(argc, argv, 2, &options)) {
+        return runConvert(&options);
+    }
+    else if (mode == "import" && readOptions(argc, argv, 2, &options)) {
+        return runImport(&options);
+    }
+    else if (mode == "verify" && argc <= 3) {
+        return argc == 3 ? runVerifySet(argv[2]) : runVerify();
+    }
+    else if (mode == "enumerate" && argc >= 3) {
+        options.limit = PTRDIFF_MAX;
+        if (readOptions(argc, argv, 3, &options)) {
+            return runEnumerate(argv[2], &options);
+        }
+    }
+    printUsage(argv[0]);
+    return 2;
+}
@@ -0,0 +1,111 @@
+#include "slitherlink.hpp"
+#include "parser.hpp"
+
+#include <cstdint>
+#include <string>
+
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#define BINARY_PUZZLE_MAGIC         "SLKBIN\r\n"
+#define BINARY_PUZZLE_MAGIC_SIZE    (8)
+#define BINARY_PUZZLE_VERSION       (1)
+#define BINARY_PUZZLE_BYTE_ORDER    (0x01020304)
+
+/**
+ * Header of binary puzzle file.
+ * It is followed by payload of flat arrays, in this order:
+ * int32 vertex_offsets[V + 1]      | offsets into vertex_edge_ids
+ * int32 vertex_edge_ids[]
+ * int32 edge_vertices[2 * E]
+ * int32 edge_faces[2 * E]          | OUTER_FACE for outer face
+ * int32 face_offsets[F + 1]        | offsets into face_edge_ids
+ * int32 face_edge_ids[]
+ * int8  face_values[F]             | FACE_NO_VALUE if face has no clue
+ * int8  edge_solutions[E]          | slitherlink_edge_type
+ * F does not include outer face. Checksum is FNV-1a of payload.
+ */
+typedef struct binary_puzzle_header {
+    char magic[BINARY_PUZZLE_MAGIC_SIZE];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t params_bitmap;
+    std::uint64_t no_of_vertices;
+    std::uint64_t no_of_edges;
+    std::uint64_t no_of_faces;
+    std::uint64_t no_of_vertex_edge_ids;
+    std::uint64_t no_of_face_edge_ids;
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+} binary_puzzle_header;
+
+/**
+ * View of binary puzzle, pointing directly into mapped file
+ * or memory holding it. Nothing is copied.
+ * Buffer is used only when view owns the mapped file.
+ */
+typedef struct binary_puzzle {
+    const binary_puzzle_header* header;
+    const std::int32_t* vertex_offsets;
+    const std::int32_t* vertex_edge_ids;
+    const std::int32_t* edge_vertices;
+    const std::int32_t* edge_faces;
+    const std::int32_t* face_offsets;
+    const std::int32_t* face_edge_ids;
+    const std::int8_t* face_values;
+    const std::int8_t* edge_solutions;
+    parser_buffer buffer;
+} binary_puzzle;
+
+#define CHECKSUM_OFFSET_BASIS       (0xcbf29ce484222325ULL)
+#define CHECKSUM_PRIME              (0x100000001b3ULL)
+
+/**
+ * FNV-1a checksum of data.
+ */
+std::uint64_t getChecksum(const char* data, std::size_t size);
+
+/**
+ * Continue checksum of data split into parts,
+ * starting with CHECKSUM_OFFSET_BASIS.
+ */
+std::uint64_t updateChecksum(std::uint64_t checksum, const char* data, std::size_t size);
+
+/**
+ * Checksum of topology part of binary puzzle, without clues and edge states.
+ * Puzzles on the same grid have the same topology checksum.
+ */
+std::uint64_t getTopologyChecksum(const binary_puzzle* puzzle);
+
+/**
+ * Returns true if data starts with binary puzzle magic.
+ */
+bool isBinaryPuzzle(const char* data, std::size_t size);
+
+/**
+ * Point view at binary puzzle in memory, checking its header,
+ * sizes and checksum. Data has to be aligned to 4 bytes.
+ * @return size of puzzle in bytes, 0 on error
+ */
+std::size_t readBinaryPuzzle(const char* data, std::size_t size, binary_puzzle* puzzle);
+
+/**
+ * Map binary puzzle file and point view at it.
+ * @return false if file can't be mapped or is not correct
+ */
+bool openBinaryPuzzle(const std::string& file_name, binary_puzzle* puzzle);
+
+void closeBinaryPuzzle(binary_puzzle* puzzle);
+
+/**
+ * Append binary representation of puzzle to data.
+ */
+void writeBinaryPuzzle(Slitherlink* slitherlink, std::string* data);
+
+/**
+ * Fill empty puzzle with elements of binary puzzle.
+ * References are not evaluated.
+ */
+int loadBinaryPuzzle(const binary_puzzle* puzzle, Slitherlink* slitherlink);
+
+#endif // BINARY_FORMAT_H
@@ -0,0 +1,74 @@
+#include "slitherlink.hpp"
+
+#include <cstdint>
+#include <string>
+
+#ifndef CLUE_FORMAT_H
+#define CLUE_FORMAT_H
+
+#define CLUE_RECORD_MAGIC           "SLKC"
+#define CLUE_RECORD_MAGIC_SIZE      (4)
+#define CLUE_RECORD_VERSION         (1)
+#define CLUE_RECORD_WITH_SOLUTION   (0b1)
+
+/**
+ * Bigger grids would take terabytes, the bound keeps
+ * record size arithmetic of untrusted headers from overflowing.
+ */
+#define CLUE_RECORD_MAX_GRID_SIZE   (1 << 20)
+
+/**
+ * Clue-only record of puzzle on hexagonal grid built by Slitherlink(size).
+ * Header is followed by:
+ * uint8 clues[(F + 1) / 2]         | 4 bits per face, 0 - no clue, value + 1 otherwise
+ * uint8 solution[(E + 7) / 8]      | only with CLUE_RECORD_WITH_SOLUTION, bit set if edge is in solution
+ * F does not include outer face, lower nibble and lower bit come first.
+ */
+typedef struct clue_record_header {
+    char magic[CLUE_RECORD_MAGIC_SIZE];
+    std::uint8_t version;
+    std::uint8_t flags;
+    std::uint16_t reserved;
+    std::uint32_t size;
+} clue_record_header;
+
+/**
+ * Returns size of hexagonal grid with given number of faces (with outer face),
+ * -1 if there is no such grid.
+ */
+std::ptrdiff_t getHexGridSize(std::ptrdiff_t no_of_faces);
+
+/**
+ * Header of record for hexagonal grid of given size, for writers
+ * that stream clues without building the puzzle.
+ */
+void makeClueRecordHeader(std::ptrdiff_t size, bool with_solution, clue_record_header* header);
+
+/**
+ * Append clue record of puzzle to data.
+ * @return false if puzzle is not on canonical hexagonal grid
+ */
+bool writeCluePuzzle(Slitherlink* slitherlink, bool with_solution, std::string* data);
+
+bool isCluePuzzle(const char* data, std::size_t size);
+
+/**
+ * Size of record with given header, so that it can be framed
+ * before all of it is read.
+ * @return size of record in bytes, 0 if grid size is out of bounds
+ */
+std::size_t getClueRecordSize(const clue_record_header* header);
+
+/**
+ * Fill empty puzzle with copy of canonical grid and values from record.
+ * References are not evaluated.
+ * @return size of record in bytes, 0 on error
+ */
+std::size_t loadCluePuzzle(const char* data, std::size_t size, Slitherlink* slitherlink);
+
+/**
+ * @return new puzzle decoded from record, nullptr on error
+ */
+Slitherlink* readCluePuzzle(const char* data, std::size_t size, std::size_t* record_size);
+
+#endif // CLUE_FORMAT_H
@@ -6,6 +6,11 @@
 
 #define OUTER_FACE -1
 
+/**
+ * Value of face without a clue.
+ */
+#define FACE_NO_VALUE -1
+
 /**
  * Vertex with all adjacent edge ids.
  */
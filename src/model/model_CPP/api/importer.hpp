@@ -0,0 +1,53 @@
+#include "slitherlink.hpp"
+
+#include <string>
+#include <vector>
+
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+/**
+ * Import puzzle from pzpr-style URL, e.g. https://puzz.link/p?slither/10/10/<body>.
+ * Body is decoded as in pzpr decode4Cell, '.' (question mark) has no clue.
+ * @return new puzzle on square grid, nullptr if URL is not correct
+ */
+Slitherlink* importPzprUrl(const char* begin, const char* end);
+
+/**
+ * Import puzzle from rows of digits, where '.', '-' or '?' is face without clue.
+ * Rows of lengths 1, 6, 12, ... are rings of hexagonal grid built by Slitherlink(size),
+ * rows of equal length are square grid.
+ * @return new puzzle, nullptr if rows are not correct
+ */
+Slitherlink* importClueRows(const std::vector<std::string>& rows);
+
+/**
+ * Reads puzzles in external formats from file descriptor (e.g. stdin).
+ * Every line with URL is one puzzle, other puzzles are blocks of rows
+ * separated by empty lines. Lines starting with '#' are skipped.
+ */
+class PuzzleImporter {
+    public:
+        PuzzleImporter(int fd);
+
+        /**
+         * @return next puzzle, nullptr at the end of stream or on error
+         */
+        Slitherlink* nextPuzzle();
+
+        /**
+         * @return false if some puzzle was not correct
+         */
+        bool isGood();
+
+    private:
+        int fd;
+        std::vector<char> buffer;
+        std::size_t position;
+        bool at_end;
+        bool is_good;
+
+        bool getLine(std::string* line);
+};
+
+#endif // IMPORTER_H
@@ -1,10 +1,10 @@
 #include "../../../utilities/api/trace_lib.hpp"
 #include "../api/common.hpp"
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <string>
-#include <sstream>
+#include <charconv>
+#include <cstring>
 
 #ifndef PARSER_H
 #define PARSER_H
@@ -21,6 +21,12 @@
 
 #define NO_OF_PARAMS        (9)
 
+/**
+ * Lists with at least this many lines are parsed on many threads.
+ */
+#define PARSER_PARALLEL_MIN_LINES   (1 << 15)
+#define PARSER_PARALLEL_MIN_CHUNK   (1 << 20)
+
 #define SOLVER_PARAMS_REQUIRED  (V_PRESENT | \
     E_PRESENT | \
     F_PRESENT | \
@@ -51,34 +57,115 @@ typedef enum parserState {
 typedef std::pair<std::size_t, std::size_t> edge;
 
 /**
- * Returns true if string starts with '#' character after spaces.
+ * Text of puzzle file, memory mapped if possible.
+ * Lines are tokenized in place, without copying them.
+ */
+typedef struct parser_buffer {
+    const char* begin;
+    const char* end;
+    const char* current;
+    void* mapped_data;
+    std::size_t mapped_size;
+    std::string storage;
+} parser_buffer;
+
+/**
+ * Map file of given name into buffer.
+ * Falls back to reading whole file if it can't be mapped.
+ * @return false if file can't be opened
  */
-inline bool isComment(const std::string& str){
-    size_t i = 0;
-    while (i < str.length() && std::isspace(str[i])) {
-        ++i;
+bool openParserBuffer(const std::string& file_name, parser_buffer* buffer);
+
+/**
+ * Use text already in memory, buffer takes ownership of it.
+ */
+void openParserBufferFromString(std::string text, parser_buffer* buffer);
+
+void closeParserBuffer(parser_buffer* buffer);
+
+/**
+ * Returns true if line starts with '#' character after spaces.
+ */
+inline bool isComment(const char* line_begin, const char* line_end){
+    while (line_begin < line_end && std::isspace((unsigned char)*line_begin)) {
+        ++line_begin;
     }
-    return i < str.length() && str[i] == '#';
+    return line_begin < line_end && *line_begin == '#';
 }
 
-inline std::istream& parserGetLine(std::ifstream* file, std::string* line){
+/**
+ * Find next non-comment line.
+ * @return false if end of buffer was reached
+ */
+inline bool parserGetLine(parser_buffer* buffer, const char** line_begin, const char** line_end){
     do {
-        std::getline(*file, *line);
-    } while (isComment(*line));
-    LOG_DEBUG("Reading non-comment line: ", *line);
-    return *file;
+        if (buffer->current >= buffer->end) {
+            *line_begin = buffer->end;
+            *line_end = buffer->end;
+            return false;
+        }
+        *line_begin = buffer->current;
+        const char* new_line = (const char*)std::memchr(buffer->current, '\n', buffer->end - buffer->current);
+        *line_end = new_line != nullptr ? new_line : buffer->end;
+        buffer->current = new_line != nullptr ? new_line + 1 : buffer->end;
+    } while (isComment(*line_begin, *line_end));
+    return true;
 }
 
-std::size_t convertToBitmap(std::string line);
+/**
+ * Read next whitespace separated number from line, moving line_begin past it.
+ * @return false if there is no number
+ */
+inline bool parserReadNumber(const char** line_begin, const char* line_end, std::ptrdiff_t* value){
+    const char* current = *line_begin;
+    while (current < line_end && (*current == ' ' || *current == '\t' || *current == '\r')) {
+        ++current;
+    }
+    std::from_chars_result result = std::from_chars(current, line_end, *value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    *line_begin = result.ptr;
+    return true;
+}
+
+std::size_t convertToBitmap(const char* line_begin, const char* line_end);
 
 parserState getNextState(parserState current_state, std::size_t params_bitmap);
 
-parserState readVertices(std::ifstream* file, std::ptrdiff_t no_of_vertices, std::vector<slitherlink_vertex*>* vertices);
+slitherlink_vertex* parseVertex(const char* line_begin, const char* line_end, std::ptrdiff_t i);
 
-parserState readEdges(std::ifstream* file, std::ptrdiff_t no_of_edges, std::vector<slitherlink_edge*>* edges);
+slitherlink_edge* parseEdge(const char* line_begin, const char* line_end, std::ptrdiff_t i, bool with_solution);
 
-parserState readFaces(std::ifstream* file, std::ptrdiff_t no_of_faces, std::vector<slitherlink_face*>* faces);
+/**
+ * Parse single line of list, element is expected to have id i.
+ * @return new element, nullptr if line is not correct
+ */
+slitherlink_face* parseFace(const char* line_begin, const char* line_end, std::ptrdiff_t i);
 
-parserState readCoords(std::ifstream* file, std::ptrdiff_t no_of_vertices);
+parserState readVertices(parser_buffer* buffer, std::ptrdiff_t no_of_vertices, std::vector<slitherlink_vertex*>* vertices);
+
+/**
+ * Reads list of edges, if with_solution is set then every edge
+ * has additional column with its slitherlink_edge_type.
+ */
+parserState readEdges(parser_buffer* buffer, std::ptrdiff_t no_of_edges, std::vector<slitherlink_edge*>* edges, bool with_solution);
+
+parserState readFaces(parser_buffer* buffer, std::ptrdiff_t no_of_faces, std::vector<slitherlink_face*>* faces);
+
+/**
+ * Read lists of vertices, edges and faces at once. Lines are indexed
+ * and parsed in chunks on separate threads.
+ */
+parserState readListsParallel(parser_buffer* buffer,
+                              std::ptrdiff_t no_of_vertices,
+                              std::ptrdiff_t no_of_edges,
+                              std::ptrdiff_t no_of_faces,
+                              bool with_solution,
+                              std::vector<slitherlink_vertex*>* vertices,
+                              std::vector<slitherlink_edge*>* edges,
+                              std::vector<slitherlink_face*>* faces);
+
+parserState readCoords(parser_buffer* buffer, std::ptrdiff_t no_of_vertices);
 
 #endif // PARSER_H
\ No newline at end of file
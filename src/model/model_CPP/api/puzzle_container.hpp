@@ -0,0 +1,131 @@
+#include "slitherlink.hpp"
+#include "binary_format.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef PUZZLE_CONTAINER_H
+#define PUZZLE_CONTAINER_H
+
+#define CONTAINER_MAGIC             "SLKPACK\n"
+#define CONTAINER_INDEX_MAGIC       "SLKINDEX"
+#define CONTAINER_VERSION           (1)
+
+/**
+ * Layout of container file, every record is 8 bytes aligned:
+ * container_header
+ * records: container_record_header followed by payload
+ *  - CONTAINER_RECORD_TOPOLOGY: binary puzzle, reference is its topology checksum
+ *  - CONTAINER_RECORD_PUZZLE: int8 face_values[F], int8 edge_solutions[E],
+ *    reference is offset of topology record of the puzzle
+ *  - CONTAINER_RECORD_INDEX: uint64 offsets of puzzle records
+ * container_footer, written on close
+ * Container without footer (e.g. writer was killed) is read by scanning records.
+ */
+typedef enum container_record_type {
+    CONTAINER_RECORD_TOPOLOGY = 1,
+    CONTAINER_RECORD_PUZZLE,
+    CONTAINER_RECORD_INDEX
+} container_record_type;
+
+typedef struct container_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+} container_header;
+
+typedef struct container_record_header {
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t payload_size;
+    std::uint64_t reference;
+    std::uint64_t params_bitmap;
+    std::uint64_t checksum;
+} container_record_header;
+
+typedef struct container_footer {
+    std::uint64_t index_offset;
+    std::uint64_t no_of_puzzles;
+    char magic[8];
+} container_footer;
+
+/**
+ * Appends puzzles to container file, creating it if it does not exist.
+ * Puzzles on already stored grid share its topology record.
+ * append can be called from many threads at once.
+ */
+class PuzzleContainerWriter {
+    public:
+        PuzzleContainerWriter(std::string file_name);
+
+        ~PuzzleContainerWriter();
+
+        bool isOpen();
+
+        /**
+         * @return id of appended puzzle, -1 on error
+         */
+        std::ptrdiff_t append(Slitherlink* puzzle);
+
+        std::ptrdiff_t getNoOfPuzzles();
+
+        /**
+         * Write index and footer and close file.
+         */
+        bool close();
+
+    private:
+        std::mutex mutex;
+        std::FILE* file;
+        std::uint64_t file_size;
+        std::vector<std::uint64_t> puzzle_offsets;
+        std::unordered_map<std::uint64_t, std::uint64_t> topology_offsets;
+
+        bool openExisting(const std::string& file_name);
+        bool writeRecord(const container_record_header* header, const char* payload);
+};
+
+/**
+ * Reads puzzles from mapped container file, either sequentially
+ * or by id. getPuzzle can be called from many threads at once,
+ * nextPuzzle keeps single cursor.
+ */
+class PuzzleContainerReader {
+    public:
+        PuzzleContainerReader(std::string file_name);
+
+        ~PuzzleContainerReader();
+
+        bool isOpen();
+
+        std::ptrdiff_t getNoOfPuzzles();
+
+        /**
+         * @return puzzle of given id, nullptr on error
+         */
+        Slitherlink* getPuzzle(std::ptrdiff_t id);
+
+        /**
+         * @return next puzzle in file, nullptr at the end
+         */
+        Slitherlink* nextPuzzle();
+
+        void rewind();
+
+    private:
+        std::mutex mutex;
+        parser_buffer buffer;
+        bool is_open;
+        std::uint64_t cursor;
+        std::vector<std::uint64_t> puzzle_offsets;
+        std::unordered_map<std::uint64_t, binary_puzzle> topologies;
+
+        const container_record_header* getRecord(std::uint64_t offset);
+        Slitherlink* readPuzzle(std::uint64_t offset);
+};
+
+#endif // PUZZLE_CONTAINER_H
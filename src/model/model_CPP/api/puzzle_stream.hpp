@@ -0,0 +1,61 @@
+#include "slitherlink.hpp"
+#include "../../../utilities/api/buffered_writer.hpp"
+
+#include <string>
+#include <vector>
+
+#ifndef PUZZLE_STREAM_H
+#define PUZZLE_STREAM_H
+
+#define PUZZLE_STREAM_CHUNK_SIZE    (1 << 16)
+
+typedef enum puzzle_format {
+    PUZZLE_FORMAT_TEXT,
+    PUZZLE_FORMAT_BINARY,
+    PUZZLE_FORMAT_CLUE
+} puzzle_format;
+
+/**
+ * @return false if name is not one of "text", "binary", "clue"
+ */
+bool getPuzzleFormat(const std::string& name, puzzle_format* format);
+
+/**
+ * Write puzzle as single record of stream.
+ * Clue records get edges only if all of them are known.
+ * @return false if puzzle can't be written in given format
+ */
+bool writePuzzle(Slitherlink* slitherlink, puzzle_format format, BufferedWriter* writer);
+
+/**
+ * Reads concatenated puzzles in any format from file descriptor (e.g. stdin)
+ * as they arrive, so it can be used in the middle of pipeline.
+ * Records are framed by their counts (text) or sizes (binary, clue)
+ * before they are parsed.
+ */
+class PuzzleStreamReader {
+    public:
+        PuzzleStreamReader(int fd);
+
+        /**
+         * @return next puzzle, nullptr at the end of stream or on error
+         */
+        Slitherlink* nextPuzzle();
+
+        /**
+         * @return false if stream ended in the middle of puzzle
+         */
+        bool isGood();
+
+    private:
+        int fd;
+        std::vector<char> buffer;
+        std::size_t no_of_used;
+        bool at_end;
+        bool is_good;
+
+        bool readChunk();
+        std::size_t getRecordSize();
+};
+
+#endif // PUZZLE_STREAM_H
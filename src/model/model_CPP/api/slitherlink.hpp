@@ -6,6 +6,10 @@
 #ifndef SLITHERLINK_H
 #define SLITHERLINK_H
 
+typedef struct binary_puzzle binary_puzzle;
+typedef struct parser_buffer parser_buffer;
+class BufferedWriter;
+
 class Slitherlink {
     public:
         std::size_t params_bitmap;
@@ -18,9 +22,21 @@ class Slitherlink {
 
         /**
          * Construct Slitherlink puzzle by reading values from a file of given name
+         * @note file can be in text, binary or clue format
          */
         Slitherlink(std::string file_name);
 
+        /**
+         * Construct Slitherlink puzzle from text, binary or clue data
+         * at current position of buffer, moving it past the puzzle
+         */
+        Slitherlink(parser_buffer* buffer);
+
+        /**
+         * Construct Slitherlink puzzle from binary puzzle view
+         */
+        Slitherlink(const binary_puzzle* puzzle);
+
         /**
          * Construct Slitherlink puzzle by passing parameters
          */
@@ -37,22 +53,78 @@ class Slitherlink {
          * @param size size of the puzzle
          * @note size is the number of layers in the puzzle
          * @note size = 1 is the smallest puzzle, which is a hexagon
+         * @note elements are copied from topology cache, grid is built once per size
          */
         Slitherlink(std::ptrdiff_t size);
 
+        /**
+         * Construct blank Slitherlink puzzle on square grid
+         * @note faces are numbered row by row, id = y * width + x
+         * @note elements are copied from topology cache, grid is built once per size
+         */
+        Slitherlink(std::ptrdiff_t width, std::ptrdiff_t height);
+
+        /**
+         * Load puzzle in text, binary or clue format at current position
+         * of buffer, unlike the constructor wrong data is not asserted
+         * @return nullptr if data is not correct puzzle
+         */
+        static Slitherlink* load(parser_buffer* buffer);
+
+        /**
+         * Load puzzle from binary puzzle view, unlike the constructor
+         * wrong data is not asserted
+         * @return nullptr if puzzle is not correct
+         */
+        static Slitherlink* loadBinary(const binary_puzzle* puzzle);
+
+        /**
+         * Build blank hexagonal grid layer by layer, used by topology cache
+         */
+        static Slitherlink* buildHexagonal(std::ptrdiff_t size);
+
+        /**
+         * Build blank square grid row by row, used by topology cache
+         */
+        static Slitherlink* buildSquare(std::ptrdiff_t width, std::ptrdiff_t height);
+
         ~Slitherlink();
 
-        Slitherlink* copy();
+        Slitherlink* copy() const;
 
         void printPuzzle(std::ofstream* ofstream);
 
+        /**
+         * Print puzzle in text format, same as printPuzzle(std::ofstream*).
+         */
+        void printPuzzle(BufferedWriter* writer);
+
         void savePuzzle(std::string file_name);
 
+        /**
+         * Save puzzle with its edge states in binary format.
+         */
+        void saveBinaryPuzzle(std::string file_name);
+
+        /**
+         * Save only clues (and edges of solution) of puzzle on hexagonal grid.
+         */
+        void saveCluePuzzle(std::string file_name, bool with_solution);
+
         int evaluateReferences();
 
         bool checkCorrectness();
 
         void clearSolution();
+
+    private:
+        Slitherlink();
+
+        /**
+         * Copy elements of other puzzle, references are mapped by ids
+         * instead of being evaluated again.
+         */
+        void copyElements(const Slitherlink* other);
 };
 
 #endif // SLITHERLINK_H
\ No newline at end of file
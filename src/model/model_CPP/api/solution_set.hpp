@@ -0,0 +1,137 @@
+#include "slitherlink.hpp"
+#include "parser.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifndef SOLUTION_SET_H
+#define SOLUTION_SET_H
+
+#define SOLUTION_SET_MAGIC              "SLKSOLS\n"
+#define SOLUTION_SET_VERSION            (1)
+#define SOLUTION_SET_KEYFRAME_INTERVAL  (256)
+
+/**
+ * Layout of solution set file:
+ * solution_set_header
+ * records, one per solution, first byte is solution_record_type:
+ *  - SOLUTION_RECORD_FULL: bits of edges in solution, (E + 7) / 8 bytes
+ *  - SOLUTION_RECORD_XOR_BITS: bits of edges changed since previous solution
+ *  - SOLUTION_RECORD_XOR_LIST: varint number of changed edges, then varint
+ *    gaps between their ids, used when it is shorter than bits
+ * uint64 offsets of keyframes (every keyframe_interval-th record is full)
+ * Checksum is FNV-1a of records and index.
+ */
+typedef enum solution_record_type {
+    SOLUTION_RECORD_FULL,
+    SOLUTION_RECORD_XOR_BITS,
+    SOLUTION_RECORD_XOR_LIST
+} solution_record_type;
+
+typedef struct solution_set_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t no_of_edges;
+    std::uint64_t no_of_solutions;
+    std::uint64_t keyframe_interval;
+    std::uint64_t index_offset;
+    std::uint64_t checksum;
+} solution_set_header;
+
+/**
+ * Writes solutions of one puzzle, each delta-encoded against previous one.
+ */
+class SolutionSetWriter {
+    public:
+        SolutionSetWriter(std::string file_name,
+                          std::ptrdiff_t no_of_edges,
+                          std::ptrdiff_t keyframe_interval = SOLUTION_SET_KEYFRAME_INTERVAL);
+
+        ~SolutionSetWriter();
+
+        bool isOpen();
+
+        bool append(Slitherlink* solution);
+
+        std::ptrdiff_t getNoOfSolutions();
+
+        /**
+         * Write index and final header and close file.
+         */
+        bool close();
+
+    private:
+        std::FILE* file;
+        solution_set_header header;
+        std::uint64_t file_size;
+        std::vector<std::uint8_t> previous;
+        std::vector<std::uint8_t> current;
+        std::vector<std::uint8_t> record;
+        std::vector<std::uint64_t> keyframe_offsets;
+
+        bool write(const void* data, std::size_t size);
+};
+
+/**
+ * Iterates solutions of mapped solution set without building Slitherlink
+ * objects. Current solution is kept as bits of edges.
+ */
+class SolutionSetReader {
+    public:
+        SolutionSetReader(std::string file_name);
+
+        ~SolutionSetReader();
+
+        bool isOpen();
+
+        std::ptrdiff_t getNoOfSolutions();
+
+        std::ptrdiff_t getNoOfEdges();
+
+        /**
+         * Move to next solution.
+         * @return false at the end of set
+         */
+        bool nextSolution();
+
+        /**
+         * Move to solution of given index, starting from nearest keyframe.
+         * Following nextSolution() moves to index + 1.
+         */
+        bool seekSolution(std::ptrdiff_t index);
+
+        /**
+         * @return index of current solution, -1 before first one
+         */
+        std::ptrdiff_t getIndex();
+
+        inline bool isInSolution(std::ptrdiff_t edge_id) const {
+            return (bits[edge_id / 8] >> (edge_id % 8)) & 1;
+        }
+
+        /**
+         * Bits of edges in current solution, lower bit of first byte is edge 0.
+         */
+        const std::vector<std::uint8_t>& getBits() const;
+
+        /**
+         * Set edges of puzzle to current solution.
+         */
+        void applySolution(Slitherlink* slitherlink);
+
+    private:
+        parser_buffer buffer;
+        bool is_open;
+        const solution_set_header* header;
+        const std::uint64_t* keyframe_offsets;
+        std::ptrdiff_t index;
+        std::uint64_t offset;
+        std::vector<std::uint8_t> bits;
+
+        bool readRecord();
+};
+
+#endif // SOLUTION_SET_H
@@ -0,0 +1,21 @@
+#include "slitherlink.hpp"
+
+#include <cstddef>
+
+#ifndef TOPOLOGY_CACHE_H
+#define TOPOLOGY_CACHE_H
+
+typedef enum grid_type {
+    GRID_HEXAGONAL,
+    GRID_SQUARE
+} grid_type;
+
+/**
+ * Returns blank puzzle of given grid type and size, built once per process
+ * and shared by all threads. Returned puzzle must not be modified.
+ * @param width size of hexagonal grid or width of square grid
+ * @param height height of square grid, not used for hexagonal grid
+ */
+const Slitherlink* getBlankTopology(grid_type type, std::ptrdiff_t width, std::ptrdiff_t height = 0);
+
+#endif // TOPOLOGY_CACHE_H
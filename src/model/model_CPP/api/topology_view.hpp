@@ -0,0 +1,461 @@
+#include "slitherlink.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef TOPOLOGY_VIEW_H
+#define TOPOLOGY_VIEW_H
+
+/**
+ * Topology views give algorithms templated on them the same queries:
+ * number of elements, vertices and faces of edge, edges of vertex and face.
+ * Faces are counted without outer face, which has id OUTER_FACE.
+ * makeVertexArray<T>() and makeFaceArray<T>() give zeroed state of elements,
+ * face array has outer face at the end.
+ */
+
+/**
+ * View of explicit puzzle, relations are read from its id lists.
+ */
+class SlitherlinkTopology {
+    public:
+        explicit SlitherlinkTopology(const Slitherlink* slitherlink) : slitherlink(slitherlink) {}
+
+        inline std::ptrdiff_t getNoOfVertices() const {
+            return slitherlink->no_of_vertices;
+        }
+
+        inline std::ptrdiff_t getNoOfEdges() const {
+            return slitherlink->no_of_edges;
+        }
+
+        inline std::ptrdiff_t getNoOfFaces() const {
+            return slitherlink->no_of_faces - 1;
+        }
+
+        template<typename T>
+        inline std::vector<T> makeVertexArray() const {
+            return std::vector<T>(getNoOfVertices(), T());
+        }
+
+        template<typename T>
+        inline std::vector<T> makeFaceArray() const {
+            return std::vector<T>(getNoOfFaces() + 1, T());
+        }
+
+        inline std::ptrdiff_t getEdgeVertex(std::ptrdiff_t edge_id, int i) const {
+            return slitherlink->edges[edge_id]->vertices[i];
+        }
+
+        inline std::ptrdiff_t getEdgeFace(std::ptrdiff_t edge_id, int i) const {
+            return slitherlink->edges[edge_id]->face_ids[i];
+        }
+
+        template<typename Function>
+        inline void forEachVertexEdge(std::ptrdiff_t vertex_id, Function function) const {
+            for (std::ptrdiff_t edge_id : slitherlink->vertices[vertex_id]->edge_ids) {
+                function(edge_id);
+            }
+        }
+
+        template<typename Function>
+        inline void forEachFaceEdge(std::ptrdiff_t face_id, Function function) const {
+            for (std::ptrdiff_t edge_id : slitherlink->faces[face_id]->edge_ids) {
+                function(edge_id);
+            }
+        }
+
+    private:
+        const Slitherlink* slitherlink;
+};
+
+/**
+ * Implicit view of hexagonal grid built by Slitherlink(size), relations
+ * are computed from ring coordinates and no adjacency is stored.
+ * Ids are the same as in explicit grid:
+ * - vertex ring L has 12L + 6 vertices starting at 6L^2
+ * - 6L radial edges between vertex rings L - 1 and L start at 9L^2 - 3L,
+ *   12L + 6 edges of vertex ring L follow them
+ * - face ring L has 6L faces starting at 1 + 3L(L - 1), face 0 is in the middle
+ * Ring is split into 6 sides starting after its corner vertex. Vertex at odd
+ * position of side has edge to inner ring, others have edge to outer ring.
+ */
+class HexTopology {
+    public:
+        constexpr explicit HexTopology(std::ptrdiff_t size) : size(size) {}
+
+        constexpr std::ptrdiff_t getSize() const {
+            return size;
+        }
+
+        constexpr std::ptrdiff_t getNoOfVertices() const {
+            return 6 * size * size;
+        }
+
+        constexpr std::ptrdiff_t getNoOfEdges() const {
+            return 9 * size * size - 3 * size;
+        }
+
+        constexpr std::ptrdiff_t getNoOfFaces() const {
+            return 3 * size * size - 3 * size + 1;
+        }
+
+        template<typename T>
+        inline std::vector<T> makeVertexArray() const {
+            return std::vector<T>(getNoOfVertices(), T());
+        }
+
+        template<typename T>
+        inline std::vector<T> makeFaceArray() const {
+            return std::vector<T>(getNoOfFaces() + 1, T());
+        }
+
+        inline std::ptrdiff_t getEdgeVertex(std::ptrdiff_t edge_id, int i) const {
+            std::ptrdiff_t ring = getEdgeRing(edge_id);
+            return getEdgeVertex(ring, edge_id - (9 * ring * ring - 3 * ring), i);
+        }
+
+        inline std::ptrdiff_t getEdgeFace(std::ptrdiff_t edge_id, int i) const {
+            std::ptrdiff_t ring = getEdgeRing(edge_id);
+            return getEdgeFace(ring, edge_id - (9 * ring * ring - 3 * ring), i);
+        }
+
+        template<typename Function>
+        inline void forEachVertexEdge(std::ptrdiff_t vertex_id, Function function) const {
+            std::ptrdiff_t ring = getVertexRing(vertex_id);
+            forEachVertexEdge(ring, vertex_id - 6 * ring * ring, function);
+        }
+
+        template<typename Function>
+        inline void forEachFaceEdge(std::ptrdiff_t face_id, Function function) const {
+            std::ptrdiff_t ring = getFaceRing(face_id);
+            forEachFaceEdge(ring, face_id == 0 ? 0 : face_id - (1 + 3 * ring * (ring - 1)), function);
+        }
+
+        /**
+         * Same queries for element given by its ring and index in the ring,
+         * e.g. when rings are walked in order. Edge index counts radial
+         * edges of ring first. They need no square root, so they are constexpr.
+         */
+        constexpr std::ptrdiff_t getEdgeVertex(std::ptrdiff_t ring, std::ptrdiff_t index, int i) const {
+            if (index >= 6 * ring) {
+                return getVertexId(ring, index - 6 * ring + i);
+            }
+            std::ptrdiff_t side = getRadialSide(ring, index);
+            return i == 0 ? getSideVertexId(ring - 1, getInnerPosition(ring, side)) :
+                            getSideVertexId(ring, getOuterPosition(ring, side));
+        }
+
+        constexpr std::ptrdiff_t getEdgeFace(std::ptrdiff_t ring, std::ptrdiff_t index, int i) const {
+            if (index < 6 * ring) {
+                return getFaceId(ring, getRadialSide(ring, index) + ring / 2 + i);
+            }
+            // side coordinates of first vertex of ring edge
+            std::ptrdiff_t position = getMod(index - 6 * ring - ring - 1, 12 * ring + 6);
+            std::ptrdiff_t side = position / (2 * ring + 1);
+            std::ptrdiff_t offset = position % (2 * ring + 1);
+            if (i == 0) {
+                if (ring == 0) {
+                    return 0;
+                }
+                return getFaceId(ring, side * ring + (offset + 1) / 2 - 1 + ring / 2 + 1);
+            }
+            if (ring == size - 1) {
+                return OUTER_FACE;
+            }
+            return getFaceId(ring + 1, side * (ring + 1) + offset / 2 + (ring + 1) / 2 + 1);
+        }
+
+        template<typename Function>
+        constexpr void forEachVertexEdge(std::ptrdiff_t ring, std::ptrdiff_t index, Function function) const {
+            function(getRingEdgeId(ring, index - 1));
+            function(getRingEdgeId(ring, index));
+            std::ptrdiff_t position = getMod(index - ring - 1, 12 * ring + 6);
+            std::ptrdiff_t side = position / (2 * ring + 1);
+            std::ptrdiff_t offset = position % (2 * ring + 1);
+            if (offset % 2 == 1) {
+                function(getRadialEdgeId(ring, side * ring + offset / 2));
+            }
+            else if (ring < size - 1) {
+                function(getRadialEdgeId(ring + 1, side * (ring + 1) + offset / 2));
+            }
+        }
+
+        template<typename Function>
+        constexpr void forEachFaceEdge(std::ptrdiff_t ring, std::ptrdiff_t index, Function function) const {
+            if (ring == 0) {
+                for (std::ptrdiff_t i = 0; i < 6; ++i) {
+                    function(getRingEdgeId(0, i));
+                }
+                return;
+            }
+            // face lies between two consecutive radial edges
+            std::ptrdiff_t last_side = index - ring / 2;
+            std::ptrdiff_t first_side = last_side - 1;
+            function(getRadialEdgeId(ring, first_side));
+            std::ptrdiff_t inner_begin = getInnerPosition(ring, getMod(first_side, 6 * ring));
+            std::ptrdiff_t inner_end = getInnerPosition(ring, getMod(last_side, 6 * ring));
+            std::ptrdiff_t no_of_inner = getMod(inner_end - inner_begin, 12 * ring - 6);
+            for (std::ptrdiff_t i = 0; i < no_of_inner; ++i) {
+                function(getRingEdgeId(ring - 1, inner_begin + i + ring));
+            }
+            function(getRadialEdgeId(ring, last_side));
+            std::ptrdiff_t outer_begin = getOuterPosition(ring, getMod(first_side, 6 * ring));
+            std::ptrdiff_t outer_end = getOuterPosition(ring, getMod(last_side, 6 * ring));
+            std::ptrdiff_t no_of_outer = getMod(outer_end - outer_begin, 12 * ring + 6);
+            for (std::ptrdiff_t i = 0; i < no_of_outer; ++i) {
+                function(getRingEdgeId(ring, outer_begin + i + ring + 1));
+            }
+        }
+
+    private:
+        std::ptrdiff_t size;
+
+        static constexpr std::ptrdiff_t getMod(std::ptrdiff_t value, std::ptrdiff_t modulus){
+            value %= modulus;
+            return value < 0 ? value + modulus : value;
+        }
+
+        /**
+         * Largest ring whose first id given by quadratic is not above id.
+         */
+        template<typename FirstId>
+        static inline std::ptrdiff_t getRing(std::ptrdiff_t id, double scale, FirstId first_id){
+            std::ptrdiff_t ring = (std::ptrdiff_t)std::sqrt(id / scale);
+            while (ring > 0 && first_id(ring) > id) {
+                ring--;
+            }
+            while (first_id(ring + 1) <= id) {
+                ring++;
+            }
+            return ring;
+        }
+
+        static inline std::ptrdiff_t getVertexRing(std::ptrdiff_t vertex_id){
+            return getRing(vertex_id, 6.0, [](std::ptrdiff_t ring){ return 6 * ring * ring; });
+        }
+
+        static inline std::ptrdiff_t getEdgeRing(std::ptrdiff_t edge_id){
+            return getRing(edge_id, 9.0, [](std::ptrdiff_t ring){ return 9 * ring * ring - 3 * ring; });
+        }
+
+        static inline std::ptrdiff_t getFaceRing(std::ptrdiff_t face_id){
+            return getRing(face_id, 3.0, [](std::ptrdiff_t ring){ return ring == 0 ? 0 : 1 + 3 * ring * (ring - 1); });
+        }
+
+        static constexpr std::ptrdiff_t getVertexId(std::ptrdiff_t ring, std::ptrdiff_t index){
+            return 6 * ring * ring + getMod(index, 12 * ring + 6);
+        }
+
+        /**
+         * Position counts from the first vertex after corner of the ring.
+         */
+        static constexpr std::ptrdiff_t getSideVertexId(std::ptrdiff_t ring, std::ptrdiff_t position){
+            return getVertexId(ring, position + ring + 1);
+        }
+
+        static constexpr std::ptrdiff_t getRingEdgeId(std::ptrdiff_t ring, std::ptrdiff_t index){
+            return 9 * ring * ring + 3 * ring + getMod(index, 12 * ring + 6);
+        }
+
+        /**
+         * Radial edges of ring are numbered from the middle of first side.
+         */
+        static constexpr std::ptrdiff_t getRadialEdgeId(std::ptrdiff_t ring, std::ptrdiff_t side_index){
+            return 9 * ring * ring - 3 * ring + getMod(side_index + (ring + 1) / 2, 6 * ring);
+        }
+
+        static constexpr std::ptrdiff_t getRadialSide(std::ptrdiff_t ring, std::ptrdiff_t index){
+            return getMod(index - (ring + 1) / 2, 6 * ring);
+        }
+
+        static constexpr std::ptrdiff_t getFaceId(std::ptrdiff_t ring, std::ptrdiff_t index){
+            return 1 + 3 * ring * (ring - 1) + getMod(index, 6 * ring);
+        }
+
+        /**
+         * Side position of vertex of radial edge in inner ring.
+         */
+        static constexpr std::ptrdiff_t getInnerPosition(std::ptrdiff_t ring, std::ptrdiff_t side_index){
+            return side_index / ring * (2 * ring - 1) + 2 * (side_index % ring);
+        }
+
+        /**
+         * Side position of vertex of radial edge in outer ring.
+         */
+        static constexpr std::ptrdiff_t getOuterPosition(std::ptrdiff_t ring, std::ptrdiff_t side_index){
+            return side_index / ring * (2 * ring + 1) + 2 * (side_index % ring) + 1;
+        }
+};
+
+/**
+ * Hexagonal grids of these sizes have compile-time topology.
+ */
+#define FIXED_HEX_MIN_SIZE      (3)
+#define FIXED_HEX_MAX_SIZE      (10)
+
+/**
+ * Adjacency of hexagonal grid of fixed size, ids fit in 16 bits.
+ * Every face of hexagonal grid has 6 edges, vertex has 2 or 3,
+ * missing third edge is -1.
+ */
+template<std::ptrdiff_t SIZE>
+struct fixed_hex_tables {
+    static constexpr std::ptrdiff_t NO_OF_VERTICES = 6 * SIZE * SIZE;
+    static constexpr std::ptrdiff_t NO_OF_EDGES = 9 * SIZE * SIZE - 3 * SIZE;
+    static constexpr std::ptrdiff_t NO_OF_FACES = 3 * SIZE * SIZE - 3 * SIZE + 1;
+    static_assert(NO_OF_EDGES <= INT16_MAX, "ids of fixed grid must fit in 16 bits");
+
+    std::array<std::array<std::int16_t, 2>, NO_OF_EDGES> edge_vertices;
+    std::array<std::array<std::int16_t, 2>, NO_OF_EDGES> edge_faces;
+    std::array<std::array<std::int16_t, 3>, NO_OF_VERTICES> vertex_edges;
+    std::array<std::array<std::int16_t, 6>, NO_OF_FACES> face_edges;
+};
+
+/**
+ * Tables are filled from implicit grid walked ring by ring at compile time.
+ */
+template<std::ptrdiff_t SIZE>
+constexpr fixed_hex_tables<SIZE> buildFixedHexTables(){
+    fixed_hex_tables<SIZE> tables{};
+    HexTopology topology(SIZE);
+    std::ptrdiff_t edge_id = 0;
+    std::ptrdiff_t vertex_id = 0;
+    std::ptrdiff_t face_id = 0;
+    for (std::ptrdiff_t ring = 0; ring < SIZE; ++ring) {
+        for (std::ptrdiff_t index = 0; index < 18 * ring + 6; ++index, ++edge_id) {
+            for (int i = 0; i < 2; ++i) {
+                tables.edge_vertices[edge_id][i] = topology.getEdgeVertex(ring, index, i);
+                tables.edge_faces[edge_id][i] = topology.getEdgeFace(ring, index, i);
+            }
+        }
+        for (std::ptrdiff_t index = 0; index < 12 * ring + 6; ++index, ++vertex_id) {
+            std::array<std::int16_t, 3>& edges = tables.vertex_edges[vertex_id];
+            edges[2] = -1;
+            std::ptrdiff_t i = 0;
+            topology.forEachVertexEdge(ring, index, [&](std::ptrdiff_t id){ edges[i++] = id; });
+        }
+        for (std::ptrdiff_t index = 0; index < (ring == 0 ? 1 : 6 * ring); ++index, ++face_id) {
+            std::array<std::int16_t, 6>& edges = tables.face_edges[face_id];
+            std::ptrdiff_t i = 0;
+            topology.forEachFaceEdge(ring, index, [&](std::ptrdiff_t id){ edges[i++] = id; });
+        }
+    }
+    return tables;
+}
+
+/**
+ * Hexagonal grid whose size is known at compile time. Adjacency is in
+ * constexpr tables, loops over edges of element have constant bounds
+ * and state of elements fits in std::array, so no heap is used.
+ */
+template<std::ptrdiff_t SIZE>
+class FixedHexTopology {
+    public:
+        typedef fixed_hex_tables<SIZE> tables;
+
+        constexpr std::ptrdiff_t getSize() const {
+            return SIZE;
+        }
+
+        constexpr std::ptrdiff_t getNoOfVertices() const {
+            return tables::NO_OF_VERTICES;
+        }
+
+        constexpr std::ptrdiff_t getNoOfEdges() const {
+            return tables::NO_OF_EDGES;
+        }
+
+        constexpr std::ptrdiff_t getNoOfFaces() const {
+            return tables::NO_OF_FACES;
+        }
+
+        template<typename T>
+        constexpr std::array<T, tables::NO_OF_VERTICES> makeVertexArray() const {
+            return {};
+        }
+
+        template<typename T>
+        constexpr std::array<T, tables::NO_OF_FACES + 1> makeFaceArray() const {
+            return {};
+        }
+
+        constexpr std::ptrdiff_t getEdgeVertex(std::ptrdiff_t edge_id, int i) const {
+            return TABLES.edge_vertices[edge_id][i];
+        }
+
+        constexpr std::ptrdiff_t getEdgeFace(std::ptrdiff_t edge_id, int i) const {
+            return TABLES.edge_faces[edge_id][i];
+        }
+
+        template<typename Function>
+        constexpr void forEachVertexEdge(std::ptrdiff_t vertex_id, Function function) const {
+            const std::array<std::int16_t, 3>& edges = TABLES.vertex_edges[vertex_id];
+            function(edges[0]);
+            function(edges[1]);
+            if (edges[2] != -1) {
+                function(edges[2]);
+            }
+        }
+
+        template<typename Function>
+        constexpr void forEachFaceEdge(std::ptrdiff_t face_id, Function function) const {
+            for (std::int16_t edge_id : TABLES.face_edges[face_id]) {
+                function(edge_id);
+            }
+        }
+
+    private:
+        static constexpr tables TABLES = buildFixedHexTables<SIZE>();
+};
+
+/**
+ * Call function with FixedHexTopology for sizes from FIXED_HEX_MIN_SIZE
+ * to FIXED_HEX_MAX_SIZE and with HexTopology for other sizes.
+ */
+template<std::ptrdiff_t SIZE = FIXED_HEX_MIN_SIZE, typename Function>
+inline auto withHexTopology(std::ptrdiff_t size, Function function){
+    if constexpr (SIZE <= FIXED_HEX_MAX_SIZE) {
+        if (size == SIZE) {
+            return function(FixedHexTopology<SIZE>());
+        }
+        return withHexTopology<SIZE + 1>(size, function);
+    }
+    else {
+        return function(HexTopology(size));
+    }
+}
+
+/**
+ * Size of hexagonal grid with compile-time topology that has the same
+ * ids as puzzle, e.g. puzzle built by Slitherlink(size), 0 if there is none.
+ */
+inline std::ptrdiff_t getFixedHexSize(const Slitherlink* slitherlink){
+    for (std::ptrdiff_t size = FIXED_HEX_MIN_SIZE; size <= FIXED_HEX_MAX_SIZE; ++size) {
+        HexTopology topology(size);
+        if (topology.getNoOfVertices() != slitherlink->no_of_vertices ||
+            topology.getNoOfEdges() != slitherlink->no_of_edges ||
+            topology.getNoOfFaces() + 1 != slitherlink->no_of_faces) {
+            continue;
+        }
+        // edges of vertices and faces follow from vertices and faces of edges
+        bool is_same = withHexTopology(size, [slitherlink](const auto& fixed_topology){
+            for (const slitherlink_edge* edge : slitherlink->edges) {
+                for (int i = 0; i < 2; ++i) {
+                    if (edge->vertices[i] != fixed_topology.getEdgeVertex(edge->id, i) ||
+                        edge->face_ids[i] != fixed_topology.getEdgeFace(edge->id, i)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        });
+        return is_same ? size : 0;
+    }
+    return 0;
+}
+
+#endif // TOPOLOGY_VIEW_H
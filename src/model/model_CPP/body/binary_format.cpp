@@ -0,0 +1,297 @@
+#include "../api/binary_format.hpp"
+#include "../../../utilities/api/trace_lib.hpp"
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Arrays are padded so that every record is 8 bytes aligned.
+ */
+static std::size_t getPaddedSize(std::size_t size){
+    return (size + 7) & ~(std::size_t)7;
+}
+
+static std::size_t getPayloadSize(const binary_puzzle_header* header){
+    std::size_t no_of_ids = (header->no_of_vertices + 1) +
+                            header->no_of_vertex_edge_ids +
+                            4 * header->no_of_edges +
+                            (header->no_of_faces + 1) +
+                            header->no_of_face_edge_ids;
+    return getPaddedSize(no_of_ids * sizeof(std::int32_t) +
+                         header->no_of_faces + header->no_of_edges);
+}
+
+/**
+ * Offsets have to grow from 0 and stay inside list of ids they point into.
+ */
+static bool areOffsetsCorrect(const std::int32_t* offsets, std::uint64_t no_of_lists, std::uint64_t no_of_ids){
+    if (offsets[0] != 0) {
+        return false;
+    }
+    for (std::uint64_t i = 0; i < no_of_lists; ++i) {
+        if (offsets[i] > offsets[i + 1] || (std::uint64_t)offsets[i + 1] > no_of_ids) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool areIdsInRange(const std::int32_t* ids, std::uint64_t no_of_ids, std::int32_t min, std::int64_t max){
+    for (std::uint64_t i = 0; i < no_of_ids; ++i) {
+        if (ids[i] < min || ids[i] >= max) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Check every offset and id before anything is copied,
+ * so that wrong puzzle with correct checksum is not read past its end.
+ */
+static bool isPayloadCorrect(const binary_puzzle* puzzle){
+    const binary_puzzle_header* header = puzzle->header;
+    if (!areOffsetsCorrect(puzzle->vertex_offsets, header->no_of_vertices, header->no_of_vertex_edge_ids) ||
+        !areOffsetsCorrect(puzzle->face_offsets, header->no_of_faces, header->no_of_face_edge_ids)) {
+        ERROR("Binary puzzle has wrong offsets");
+        return false;
+    }
+    if (!areIdsInRange(puzzle->vertex_edge_ids, header->no_of_vertex_edge_ids, 0, header->no_of_edges) ||
+        !areIdsInRange(puzzle->face_edge_ids, header->no_of_face_edge_ids, 0, header->no_of_edges) ||
+        !areIdsInRange(puzzle->edge_vertices, 2 * header->no_of_edges, 0, header->no_of_vertices) ||
+        !areIdsInRange(puzzle->edge_faces, 2 * header->no_of_edges, OUTER_FACE, header->no_of_faces)) {
+        ERROR("Binary puzzle has ids out of range");
+        return false;
+    }
+    return true;
+}
+
+static void appendIds(std::string* data, const std::vector<std::int32_t>& ids){
+    data->append((const char*)ids.data(), ids.size() * sizeof(std::int32_t));
+}
+
+std::uint64_t getChecksum(const char* data, std::size_t size){
+    return updateChecksum(CHECKSUM_OFFSET_BASIS, data, size);
+}
+
+std::uint64_t updateChecksum(std::uint64_t checksum, const char* data, std::size_t size){
+    for (std::size_t i = 0; i < size; ++i) {
+        checksum ^= (unsigned char)data[i];
+        checksum *= CHECKSUM_PRIME;
+    }
+    return checksum;
+}
+
+std::uint64_t getTopologyChecksum(const binary_puzzle* puzzle){
+    const char* begin = (const char*)puzzle->vertex_offsets;
+    const char* end = (const char*)puzzle->face_values;
+    return getChecksum(begin, end - begin);
+}
+
+bool isBinaryPuzzle(const char* data, std::size_t size){
+    return size >= BINARY_PUZZLE_MAGIC_SIZE &&
+           std::memcmp(data, BINARY_PUZZLE_MAGIC, BINARY_PUZZLE_MAGIC_SIZE) == 0;
+}
+
+std::size_t readBinaryPuzzle(const char* data, std::size_t size, binary_puzzle* puzzle){
+    if (!isBinaryPuzzle(data, size) || size < sizeof(binary_puzzle_header)) {
+        ERROR("Not a binary puzzle");
+        return 0;
+    }
+    if ((std::uintptr_t)data % alignof(std::int32_t) != 0) {
+        ERROR("Binary puzzle is not aligned");
+        return 0;
+    }
+    const binary_puzzle_header* header = (const binary_puzzle_header*)data;
+    if (header->version != BINARY_PUZZLE_VERSION) {
+        ERROR("Unsupported binary puzzle version: ", header->version);
+        return 0;
+    }
+    if (header->byte_order != BINARY_PUZZLE_BYTE_ORDER) {
+        ERROR("Binary puzzle has different byte order");
+        return 0;
+    }
+    // ids are int32, bigger counts could also overflow size of payload
+    if (header->no_of_vertices >= INT32_MAX || header->no_of_edges >= INT32_MAX ||
+        header->no_of_faces >= INT32_MAX || header->no_of_vertex_edge_ids >= INT32_MAX ||
+        header->no_of_face_edge_ids >= INT32_MAX) {
+        ERROR("Binary puzzle is too big");
+        return 0;
+    }
+    if (header->payload_size > size - sizeof(binary_puzzle_header) ||
+        header->payload_size != getPayloadSize(header)) {
+        ERROR("Binary puzzle is truncated or has wrong sizes");
+        return 0;
+    }
+    const char* payload = data + sizeof(binary_puzzle_header);
+    if (getChecksum(payload, header->payload_size) != header->checksum) {
+        ERROR("Binary puzzle checksum mismatch");
+        return 0;
+    }
+    const std::int32_t* ids = (const std::int32_t*)payload;
+    puzzle->header = header;
+    puzzle->vertex_offsets = ids;
+    ids += header->no_of_vertices + 1;
+    puzzle->vertex_edge_ids = ids;
+    ids += header->no_of_vertex_edge_ids;
+    puzzle->edge_vertices = ids;
+    ids += 2 * header->no_of_edges;
+    puzzle->edge_faces = ids;
+    ids += 2 * header->no_of_edges;
+    puzzle->face_offsets = ids;
+    ids += header->no_of_faces + 1;
+    puzzle->face_edge_ids = ids;
+    ids += header->no_of_face_edge_ids;
+    puzzle->face_values = (const std::int8_t*)ids;
+    puzzle->edge_solutions = puzzle->face_values + header->no_of_faces;
+    if (puzzle->vertex_offsets[header->no_of_vertices] != (std::int32_t)header->no_of_vertex_edge_ids ||
+        puzzle->face_offsets[header->no_of_faces] != (std::int32_t)header->no_of_face_edge_ids) {
+        ERROR("Binary puzzle has wrong offsets");
+        return 0;
+    }
+    return sizeof(binary_puzzle_header) + header->payload_size;
+}
+
+bool openBinaryPuzzle(const std::string& file_name, binary_puzzle* puzzle){
+    if (!openParserBuffer(file_name, &puzzle->buffer)) {
+        return false;
+    }
+    if (readBinaryPuzzle(puzzle->buffer.begin,
+                         puzzle->buffer.end - puzzle->buffer.begin,
+                         puzzle) == 0) {
+        ERROR("Error while reading file: ", file_name);
+        closeParserBuffer(&puzzle->buffer);
+        return false;
+    }
+    return true;
+}
+
+void closeBinaryPuzzle(binary_puzzle* puzzle){
+    closeParserBuffer(&puzzle->buffer);
+    puzzle->header = nullptr;
+}
+
+void writeBinaryPuzzle(Slitherlink* slitherlink, std::string* data){
+    binary_puzzle_header header;
+    std::memcpy(header.magic, BINARY_PUZZLE_MAGIC, BINARY_PUZZLE_MAGIC_SIZE);
+    header.version = BINARY_PUZZLE_VERSION;
+    header.byte_order = BINARY_PUZZLE_BYTE_ORDER;
+    header.params_bitmap = slitherlink->params_bitmap;
+    header.no_of_vertices = slitherlink->no_of_vertices;
+    header.no_of_edges = slitherlink->no_of_edges;
+    header.no_of_faces = 0;
+    header.no_of_vertex_edge_ids = 0;
+    header.no_of_face_edge_ids = 0;
+
+    std::vector<std::int32_t> vertex_offsets;
+    std::vector<std::int32_t> vertex_edge_ids;
+    vertex_offsets.reserve(slitherlink->no_of_vertices + 1);
+    vertex_offsets.push_back(0);
+    for (slitherlink_vertex* vertex : slitherlink->vertices) {
+        for (std::ptrdiff_t edge_id : vertex->edge_ids) {
+            vertex_edge_ids.push_back(edge_id);
+        }
+        vertex_offsets.push_back(vertex_edge_ids.size());
+    }
+    std::vector<std::int32_t> edge_vertices;
+    std::vector<std::int32_t> edge_faces;
+    std::string edge_solutions;
+    edge_vertices.reserve(2 * slitherlink->no_of_edges);
+    edge_faces.reserve(2 * slitherlink->no_of_edges);
+    for (slitherlink_edge* edge : slitherlink->edges) {
+        edge_vertices.push_back(edge->vertices[0]);
+        edge_vertices.push_back(edge->vertices[1]);
+        edge_faces.push_back(edge->face_ids[0]);
+        edge_faces.push_back(edge->face_ids[1]);
+        edge_solutions.push_back((char)edge->solution);
+    }
+    std::vector<std::int32_t> face_offsets;
+    std::vector<std::int32_t> face_edge_ids;
+    std::string face_values;
+    face_offsets.push_back(0);
+    for (slitherlink_face* face : slitherlink->faces) {
+        if (face->id == OUTER_FACE) {
+            continue;
+        }
+        for (std::ptrdiff_t edge_id : face->edge_ids) {
+            face_edge_ids.push_back(edge_id);
+        }
+        face_offsets.push_back(face_edge_ids.size());
+        face_values.push_back((char)face->value);
+    }
+    header.no_of_faces = face_values.size();
+    header.no_of_vertex_edge_ids = vertex_edge_ids.size();
+    header.no_of_face_edge_ids = face_edge_ids.size();
+    header.payload_size = getPayloadSize(&header);
+
+    std::size_t header_offset = data->size();
+    data->append((const char*)&header, sizeof(header));
+    std::size_t payload_offset = data->size();
+    appendIds(data, vertex_offsets);
+    appendIds(data, vertex_edge_ids);
+    appendIds(data, edge_vertices);
+    appendIds(data, edge_faces);
+    appendIds(data, face_offsets);
+    appendIds(data, face_edge_ids);
+    data->append(face_values);
+    data->append(edge_solutions);
+    data->resize(payload_offset + header.payload_size, '\0');
+
+    header.checksum = getChecksum(data->data() + payload_offset, header.payload_size);
+    std::memcpy(&(*data)[header_offset], &header, sizeof(header));
+}
+
+int loadBinaryPuzzle(const binary_puzzle* puzzle, Slitherlink* slitherlink){
+    const binary_puzzle_header* header = puzzle->header;
+    if (!isPayloadCorrect(puzzle)) {
+        return -1;
+    }
+    slitherlink->params_bitmap = header->params_bitmap;
+    slitherlink->no_of_vertices = header->no_of_vertices;
+    slitherlink->no_of_edges = header->no_of_edges;
+    slitherlink->no_of_faces = header->no_of_faces + 1;
+    slitherlink->vertices.reserve(slitherlink->no_of_vertices);
+    slitherlink->edges.reserve(slitherlink->no_of_edges);
+    slitherlink->faces.reserve(slitherlink->no_of_faces);
+
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_vertices; ++i) {
+        const std::int32_t* begin = puzzle->vertex_edge_ids + puzzle->vertex_offsets[i];
+        const std::int32_t* end = puzzle->vertex_edge_ids + puzzle->vertex_offsets[i + 1];
+        slitherlink_vertex* vertex = new slitherlink_vertex{};
+        vertex->id = i;
+        vertex->no_of_edges = end - begin;
+        vertex->edge_ids.assign(begin, end);
+        slitherlink->vertices.push_back(vertex);
+    }
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
+        std::int8_t solution = puzzle->edge_solutions[i];
+        if (solution < EDGE_IN_SOLUTION || solution > EDGE_UNKNOWN) {
+            ERROR("Edge ", i, " has wrong solution value: ", (int)solution);
+            return -1;
+        }
+        slitherlink_edge* edge = new slitherlink_edge{};
+        edge->id = i;
+        edge->vertices[0] = puzzle->edge_vertices[2 * i];
+        edge->vertices[1] = puzzle->edge_vertices[2 * i + 1];
+        edge->face_ids[0] = puzzle->edge_faces[2 * i];
+        edge->face_ids[1] = puzzle->edge_faces[2 * i + 1];
+        edge->solution = (slitherlink_edge_type)solution;
+        slitherlink->edges.push_back(edge);
+    }
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)header->no_of_faces; ++i) {
+        const std::int32_t* begin = puzzle->face_edge_ids + puzzle->face_offsets[i];
+        const std::int32_t* end = puzzle->face_edge_ids + puzzle->face_offsets[i + 1];
+        slitherlink_face* face = new slitherlink_face{};
+        face->id = i;
+        face->value = puzzle->face_values[i];
+        face->no_of_edges = end - begin;
+        face->edge_ids.assign(begin, end);
+        slitherlink->faces.push_back(face);
+    }
+    // outer face has no edges listed, same as in text format
+    slitherlink_face* outer_face = new slitherlink_face{};
+    outer_face->id = OUTER_FACE;
+    outer_face->value = 0;
+    outer_face->no_of_edges = 0;
+    slitherlink->faces.push_back(outer_face);
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "../api/clue_format.hpp"
+#include "../api/parser.hpp"
+#include "../api/topology_cache.hpp"
+#include "../../../utilities/api/trace_lib.hpp"
+#include <cstring>
+
+static std::size_t getCluesSize(std::ptrdiff_t no_of_faces){
+    return (no_of_faces + 1) / 2;
+}
+
+static std::size_t getSolutionSize(std::ptrdiff_t no_of_edges){
+    return (no_of_edges + 7) / 8;
+}
+
+std::ptrdiff_t getHexGridSize(std::ptrdiff_t no_of_faces){
+    for (std::ptrdiff_t size = 1; ; ++size) {
+        std::ptrdiff_t no_of_grid_faces = 3 * size * size - 3 * size + 2;
+        if (no_of_grid_faces == no_of_faces) {
+            return size;
+        }
+        if (no_of_grid_faces > no_of_faces) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * Check that puzzle has the same elements as canonical grid.
+ */
+static bool isCanonical(Slitherlink* slitherlink, const Slitherlink* canonical){
+    if (slitherlink->no_of_vertices != canonical->no_of_vertices ||
+        slitherlink->no_of_edges != canonical->no_of_edges ||
+        slitherlink->no_of_faces != canonical->no_of_faces) {
+        return false;
+    }
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
+        slitherlink_edge* edge = slitherlink->edges[i];
+        slitherlink_edge* canonical_edge = canonical->edges[i];
+        if (edge->vertices[0] != canonical_edge->vertices[0] ||
+            edge->vertices[1] != canonical_edge->vertices[1] ||
+            edge->face_ids[0] != canonical_edge->face_ids[0] ||
+            edge->face_ids[1] != canonical_edge->face_ids[1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void makeClueRecordHeader(std::ptrdiff_t size, bool with_solution, clue_record_header* header){
+    std::memcpy(header->magic, CLUE_RECORD_MAGIC, CLUE_RECORD_MAGIC_SIZE);
+    header->version = CLUE_RECORD_VERSION;
+    header->flags = with_solution ? CLUE_RECORD_WITH_SOLUTION : 0;
+    header->reserved = 0;
+    header->size = size;
+}
+
+bool writeCluePuzzle(Slitherlink* slitherlink, bool with_solution, std::string* data){
+    std::ptrdiff_t size = getHexGridSize(slitherlink->no_of_faces);
+    if (size == -1 || !isCanonical(slitherlink, getBlankTopology(GRID_HEXAGONAL, size))) {
+        ERROR("Puzzle is not on canonical hexagonal grid");
+        return false;
+    }
+    clue_record_header header;
+    makeClueRecordHeader(size, with_solution, &header);
+    data->append((const char*)&header, sizeof(header));
+
+    std::ptrdiff_t no_of_faces = slitherlink->no_of_faces - 1;
+    std::size_t clues_offset = data->size();
+    data->append(getCluesSize(no_of_faces), '\0');
+    for (std::ptrdiff_t i = 0; i < no_of_faces; ++i) {
+        std::ptrdiff_t value = slitherlink->faces[i]->value;
+        if (value < FACE_NO_VALUE || value > 14) {
+            ERROR("Face ", i, " has value that can't be encoded: ", value);
+            return false;
+        }
+        (*data)[clues_offset + i / 2] |= (char)((value + 1) << (4 * (i % 2)));
+    }
+    if (with_solution) {
+        std::size_t solution_offset = data->size();
+        data->append(getSolutionSize(slitherlink->no_of_edges), '\0');
+        for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
+            if (slitherlink->edges[i]->solution == EDGE_IN_SOLUTION) {
+                (*data)[solution_offset + i / 8] |= (char)(1 << (i % 8));
+            }
+        }
+    }
+    return true;
+}
+
+bool isCluePuzzle(const char* data, std::size_t size){
+    return size >= CLUE_RECORD_MAGIC_SIZE &&
+           std::memcmp(data, CLUE_RECORD_MAGIC, CLUE_RECORD_MAGIC_SIZE) == 0;
+}
+
+std::size_t getClueRecordSize(const clue_record_header* header){
+    if (header->size == 0 || header->size > CLUE_RECORD_MAX_GRID_SIZE) {
+        return 0;
+    }
+    std::ptrdiff_t grid_size = header->size;
+    std::size_t record_size = sizeof(clue_record_header) +
+                              getCluesSize(3 * grid_size * grid_size - 3 * grid_size + 1);
+    if (header->flags & CLUE_RECORD_WITH_SOLUTION) {
+        record_size += getSolutionSize(9 * grid_size * grid_size - 3 * grid_size);
+    }
+    return record_size;
+}
+
+/**
+ * Check record and compute its size.
+ * @return size of record in bytes, 0 on error
+ */
+static std::size_t getRecordSize(const char* data, std::size_t size, clue_record_header* header){
+    if (!isCluePuzzle(data, size) || size < sizeof(clue_record_header)) {
+        ERROR("Not a clue puzzle");
+        return 0;
+    }
+    std::memcpy(header, data, sizeof(clue_record_header));
+    if (header->version != CLUE_RECORD_VERSION) {
+        ERROR("Unsupported clue puzzle version: ", (int)header->version);
+        return 0;
+    }
+    std::size_t record_size = getClueRecordSize(header);
+    if (record_size == 0) {
+        ERROR("Clue puzzle has wrong grid size: ", header->size);
+        return 0;
+    }
+    if (record_size > size) {
+        ERROR("Clue puzzle is truncated");
+        return 0;
+    }
+    return record_size;
+}
+
+/**
+ * @return false if some clue is bigger than number of edges of its face
+ */
+static bool applyRecord(const char* data, const clue_record_header* header, Slitherlink* slitherlink){
+    const unsigned char* clues = (const unsigned char*)data + sizeof(clue_record_header);
+    std::ptrdiff_t no_of_faces = slitherlink->no_of_faces - 1;
+    for (std::ptrdiff_t i = 0; i < no_of_faces; ++i) {
+        std::ptrdiff_t value = (std::ptrdiff_t)((clues[i / 2] >> (4 * (i % 2))) & 0xf) - 1;
+        if (value > slitherlink->faces[i]->no_of_edges) {
+            ERROR("Face ", i, " has wrong clue: ", value);
+            return false;
+        }
+        slitherlink->faces[i]->value = value;
+    }
+    if (header->flags & CLUE_RECORD_WITH_SOLUTION) {
+        const unsigned char* solution = clues + getCluesSize(no_of_faces);
+        for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
+            slitherlink->edges[i]->solution = (solution[i / 8] >> (i % 8)) & 1 ? EDGE_IN_SOLUTION
+                                                                               : EDGE_NOT_IN_SOLUTION;
+        }
+        slitherlink->params_bitmap |= SOLVED_EDGE_BIT_PRESENT;
+    }
+    return true;
+}
+
+std::size_t loadCluePuzzle(const char* data, std::size_t size, Slitherlink* slitherlink){
+    clue_record_header header;
+    std::size_t record_size = getRecordSize(data, size, &header);
+    if (record_size == 0) {
+        return 0;
+    }
+    const Slitherlink* canonical = getBlankTopology(GRID_HEXAGONAL, header.size);
+    slitherlink->params_bitmap = canonical->params_bitmap;
+    slitherlink->no_of_vertices = canonical->no_of_vertices;
+    slitherlink->no_of_edges = canonical->no_of_edges;
+    slitherlink->no_of_faces = canonical->no_of_faces;
+    slitherlink->vertices.reserve(canonical->no_of_vertices);
+    slitherlink->edges.reserve(canonical->no_of_edges);
+    slitherlink->faces.reserve(canonical->no_of_faces);
+    for (slitherlink_vertex* vertex : canonical->vertices) {
+        slitherlink->vertices.push_back(new slitherlink_vertex(*vertex));
+    }
+    for (slitherlink_edge* edge : canonical->edges) {
+        slitherlink->edges.push_back(new slitherlink_edge(*edge));
+    }
+    for (slitherlink_face* face : canonical->faces) {
+        slitherlink_face* face_copy = new slitherlink_face(*face);
+        face_copy->face_ids.clear();
+        slitherlink->faces.push_back(face_copy);
+    }
+    return applyRecord(data, &header, slitherlink) ? record_size : 0;
+}
+
+Slitherlink* readCluePuzzle(const char* data, std::size_t size, std::size_t* record_size){
+    clue_record_header header;
+    *record_size = getRecordSize(data, size, &header);
+    if (*record_size == 0) {
+        return nullptr;
+    }
+    Slitherlink* slitherlink = new Slitherlink((std::ptrdiff_t)header.size);
+    if (!applyRecord(data, &header, slitherlink)) {
+        delete slitherlink;
+        *record_size = 0;
+        return nullptr;
+    }
+    return slitherlink;
+}
@@ -28,7 +28,7 @@ inline void faceLayer(std::ptrdiff_t layer_no,
                       std::ptrdiff_t* last_id,
                       std::ptrdiff_t size);
 
-Slitherlink::Slitherlink(std::ptrdiff_t size){
+Slitherlink* Slitherlink::buildHexagonal(std::ptrdiff_t size){
     std::size_t new_params_bitmap = 0;
     std::ptrdiff_t new_no_of_vertices = 6 * size * size;
     new_params_bitmap += V_PRESENT;
@@ -108,15 +108,15 @@ Slitherlink::Slitherlink(std::ptrdiff_t size){
 
     // initialize slitherlink
 
-    this->params_bitmap = new_params_bitmap;
-    this->no_of_vertices = new_no_of_vertices;
-    this->no_of_edges = new_no_of_edges;
-    this->no_of_faces = new_no_of_faces;
-    this->vertices = new_vertices;
-    this->edges = new_edges;
-    this->faces = new_faces;
-    assert(this->evaluateReferences() == 0);
-    assert(this->checkCorrectness() == 0);
+    Slitherlink* slitherlink = new Slitherlink(new_params_bitmap,
+                                               new_no_of_vertices,
+                                               new_no_of_edges,
+                                               new_no_of_faces,
+                                               new_vertices,
+                                               new_edges,
+                                               new_faces);
+    assert(slitherlink->checkCorrectness() == 0);
+    return slitherlink;
 }
 
 
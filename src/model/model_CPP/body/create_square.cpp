@@ -0,0 +1,132 @@
+#include <cassert>
+
+#include "../api/slitherlink.hpp"
+#include "../api/parser.hpp"
+
+/**
+ * Edge ids of square grid: first horizontal edges row by row,
+ * then vertical edges row by row.
+ */
+static std::ptrdiff_t getHorizontalEdgeId(std::ptrdiff_t x, std::ptrdiff_t y, std::ptrdiff_t width){
+    return y * width + x;
+}
+
+static std::ptrdiff_t getVerticalEdgeId(std::ptrdiff_t x, std::ptrdiff_t y, std::ptrdiff_t width, std::ptrdiff_t height){
+    return (height + 1) * width + y * (width + 1) + x;
+}
+
+static std::ptrdiff_t getSquareFaceId(std::ptrdiff_t x, std::ptrdiff_t y, std::ptrdiff_t width, std::ptrdiff_t height){
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return OUTER_FACE;
+    }
+    return y * width + x;
+}
+
+Slitherlink* Slitherlink::buildSquare(std::ptrdiff_t width, std::ptrdiff_t height){
+    assert(width > 0 && height > 0);
+    std::ptrdiff_t new_no_of_vertices = (width + 1) * (height + 1);
+    std::ptrdiff_t new_no_of_edges = (height + 1) * width + height * (width + 1);
+    std::ptrdiff_t new_no_of_faces = width * height + 1; // additional 1 for outer face
+    std::vector<slitherlink_vertex*> new_vertices(new_no_of_vertices);
+    std::vector<slitherlink_edge*> new_edges(new_no_of_edges);
+    std::vector<slitherlink_face*> new_faces(new_no_of_faces);
+
+    // initialize vertices, vertex (x, y) has id y * (width + 1) + x
+    LOG_DEBUG("Generating vertices");
+    for (std::ptrdiff_t y = 0; y <= height; ++y) {
+        for (std::ptrdiff_t x = 0; x <= width; ++x) {
+            std::vector<std::ptrdiff_t> edge_ids;
+            if (y > 0) {
+                edge_ids.push_back(getVerticalEdgeId(x, y - 1, width, height));
+            }
+            if (x > 0) {
+                edge_ids.push_back(getHorizontalEdgeId(x - 1, y, width));
+            }
+            if (x < width) {
+                edge_ids.push_back(getHorizontalEdgeId(x, y, width));
+            }
+            if (y < height) {
+                edge_ids.push_back(getVerticalEdgeId(x, y, width, height));
+            }
+            std::ptrdiff_t id = y * (width + 1) + x;
+            new_vertices[id] = new slitherlink_vertex{
+                .id = id,
+                .no_of_edges = (std::ptrdiff_t)edge_ids.size(),
+                .edge_ids = edge_ids,
+                .edge_refs = {}
+            };
+        }
+    }
+
+    // initialize edges
+    LOG_DEBUG("Generating edges");
+    for (std::ptrdiff_t y = 0; y <= height; ++y) {
+        for (std::ptrdiff_t x = 0; x < width; ++x) {
+            std::ptrdiff_t id = getHorizontalEdgeId(x, y, width);
+            std::ptrdiff_t vertex_id = y * (width + 1) + x;
+            new_edges[id] = new slitherlink_edge{
+                .id = id,
+                .vertices = {vertex_id, vertex_id + 1},
+                .face_ids = {getSquareFaceId(x, y - 1, width, height),
+                             getSquareFaceId(x, y, width, height)},
+                .vertex_refs = {nullptr, nullptr},
+                .face_refs = {nullptr, nullptr},
+                .solution = EDGE_UNKNOWN
+            };
+        }
+    }
+    for (std::ptrdiff_t y = 0; y < height; ++y) {
+        for (std::ptrdiff_t x = 0; x <= width; ++x) {
+            std::ptrdiff_t id = getVerticalEdgeId(x, y, width, height);
+            std::ptrdiff_t vertex_id = y * (width + 1) + x;
+            new_edges[id] = new slitherlink_edge{
+                .id = id,
+                .vertices = {vertex_id, vertex_id + width + 1},
+                .face_ids = {getSquareFaceId(x - 1, y, width, height),
+                             getSquareFaceId(x, y, width, height)},
+                .vertex_refs = {nullptr, nullptr},
+                .face_refs = {nullptr, nullptr},
+                .solution = EDGE_UNKNOWN
+            };
+        }
+    }
+
+    // initialize faces, edges go around the face: top, right, bottom, left
+    LOG_DEBUG("Generating faces");
+    for (std::ptrdiff_t y = 0; y < height; ++y) {
+        for (std::ptrdiff_t x = 0; x < width; ++x) {
+            std::ptrdiff_t id = getSquareFaceId(x, y, width, height);
+            new_faces[id] = new slitherlink_face{
+                .id = id,
+                .value = 0,
+                .no_of_edges = 4,
+                .edge_ids = {getHorizontalEdgeId(x, y, width),
+                             getVerticalEdgeId(x + 1, y, width, height),
+                             getHorizontalEdgeId(x, y + 1, width),
+                             getVerticalEdgeId(x, y, width, height)},
+                .face_ids = {},
+                .edge_refs = {},
+                .face_refs = {}
+            };
+        }
+    }
+    // add outer face
+    new_faces[new_no_of_faces - 1] = new slitherlink_face{
+        .id = OUTER_FACE,
+        .value = 0,
+        .no_of_edges = 0,
+        .edge_ids = {},
+        .face_ids = {},
+        .edge_refs = {},
+        .face_refs = {}
+    };
+
+    return new Slitherlink(V_PRESENT | E_PRESENT | F_PRESENT |
+                           LIST_OF_VERTICES_PRESENT | LIST_OF_EDGES_PRESENT | LIST_OF_FACES_PRESENT,
+                           new_no_of_vertices,
+                           new_no_of_edges,
+                           new_no_of_faces,
+                           new_vertices,
+                           new_edges,
+                           new_faces);
+}
@@ -0,0 +1,240 @@
+#include "../api/importer.hpp"
+#include "../api/clue_format.hpp"
+#include "../../../utilities/api/trace_lib.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <unistd.h>
+
+#define IMPORTER_CHUNK_SIZE     (1 << 16)
+#define PZPR_PUZZLE_NAME        "slither/"
+/**
+ * Size in URL is only two numbers, so grid is bounded before it is built
+ */
+#define IMPORTER_MAX_NO_OF_CELLS    (1 << 16)
+
+/**
+ * Read next '/' separated token of URL.
+ */
+static bool readToken(const char** current, const char* end, const char** token_begin, const char** token_end){
+    if (*current >= end) {
+        return false;
+    }
+    *token_begin = *current;
+    const char* slash = (const char*)std::memchr(*current, '/', end - *current);
+    *token_end = slash != nullptr ? slash : end;
+    *current = slash != nullptr ? slash + 1 : end;
+    return true;
+}
+
+static bool readTokenNumber(const char* begin, const char* end, std::ptrdiff_t* value){
+    std::from_chars_result result = std::from_chars(begin, end, *value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+Slitherlink* importPzprUrl(const char* begin, const char* end){
+    const char* name = std::search(begin, end, PZPR_PUZZLE_NAME, PZPR_PUZZLE_NAME + std::strlen(PZPR_PUZZLE_NAME));
+    if (name == end) {
+        ERROR("Not a slitherlink URL");
+        return nullptr;
+    }
+    const char* current = name + std::strlen(PZPR_PUZZLE_NAME);
+    const char* token_begin = nullptr;
+    const char* token_end = nullptr;
+    std::ptrdiff_t width = 0;
+    std::ptrdiff_t height = 0;
+    // optional flags of pzpr (e.g. "v:") come before size
+    do {
+        if (!readToken(&current, end, &token_begin, &token_end)) {
+            ERROR("URL has no size");
+            return nullptr;
+        }
+    } while (!readTokenNumber(token_begin, token_end, &width));
+    if (!readToken(&current, end, &token_begin, &token_end) ||
+        !readTokenNumber(token_begin, token_end, &height) ||
+        width <= 0 || height <= 0) {
+        ERROR("URL has wrong size");
+        return nullptr;
+    }
+    if (width > IMPORTER_MAX_NO_OF_CELLS / height) {
+        ERROR("URL size ", width, "x", height, " is too big");
+        return nullptr;
+    }
+    if (!readToken(&current, end, &token_begin, &token_end)) {
+        token_begin = token_end = end;
+    }
+    Slitherlink* slitherlink = new Slitherlink(width, height);
+    std::ptrdiff_t no_of_cells = width * height;
+    for (std::ptrdiff_t i = 0; i < no_of_cells; ++i) {
+        slitherlink->faces[i]->value = FACE_NO_VALUE;
+    }
+    std::ptrdiff_t cell = 0;
+    for (const char* c = token_begin; c < token_end && cell < no_of_cells; ++c) {
+        if (*c >= '0' && *c <= '4') {
+            slitherlink->faces[cell]->value = *c - '0';
+        }
+        else if (*c >= '5' && *c <= '9') {
+            slitherlink->faces[cell]->value = *c - '5';
+            cell += 1;
+        }
+        else if (*c >= 'a' && *c <= 'e') {
+            slitherlink->faces[cell]->value = *c - 'a';
+            cell += 2;
+        }
+        else if (*c >= 'g' && *c <= 'z') {
+            cell += *c - 'g';
+        }
+        else if (*c != '.') {
+            ERROR("Wrong character in URL: ", *c);
+            delete slitherlink;
+            return nullptr;
+        }
+        cell++;
+    }
+    return slitherlink;
+}
+
+/**
+ * @return false if character is not a clue or clue is bigger than number of edges of face
+ */
+static bool readClue(char character, std::ptrdiff_t no_of_edges, std::ptrdiff_t* value){
+    if (character >= '0' && character <= '9' && character - '0' <= no_of_edges) {
+        *value = character - '0';
+        return true;
+    }
+    if (character == '.' || character == '-' || character == '?') {
+        *value = FACE_NO_VALUE;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Check that rows are rings of hexagonal grid.
+ */
+static bool isHexRows(const std::vector<std::string>& rows){
+    if (rows.size() < 2) {
+        return false;
+    }
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i].size() != (i == 0 ? 1 : 6 * i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Slitherlink* importClueRows(const std::vector<std::string>& rows){
+    if (rows.empty() || rows[0].empty()) {
+        ERROR("No rows of puzzle");
+        return nullptr;
+    }
+    Slitherlink* slitherlink = nullptr;
+    if (isHexRows(rows)) {
+        slitherlink = new Slitherlink((std::ptrdiff_t)rows.size());
+    }
+    else {
+        for (const std::string& row : rows) {
+            if (row.size() != rows[0].size()) {
+                ERROR("Rows of puzzle have different lengths");
+                return nullptr;
+            }
+        }
+        slitherlink = new Slitherlink(rows[0].size(), rows.size());
+    }
+    std::ptrdiff_t face_id = 0;
+    for (const std::string& row : rows) {
+        for (char character : row) {
+            slitherlink_face* face = slitherlink->faces[face_id];
+            if (!readClue(character, face->no_of_edges, &face->value)) {
+                ERROR("Wrong clue: ", character);
+                delete slitherlink;
+                return nullptr;
+            }
+            ++face_id;
+        }
+    }
+    return slitherlink;
+}
+
+PuzzleImporter::PuzzleImporter(int fd){
+    this->fd = fd;
+    this->position = 0;
+    this->at_end = false;
+    this->is_good = true;
+}
+
+/**
+ * Read next line without spaces and line ending.
+ * @return false at the end of stream
+ */
+bool PuzzleImporter::getLine(std::string* line){
+    line->clear();
+    while (true) {
+        const char* begin = buffer.data() + position;
+        const char* new_line = position < buffer.size() ?
+                               (const char*)std::memchr(begin, '\n', buffer.size() - position) : nullptr;
+        if (new_line != nullptr || at_end) {
+            const char* end = new_line != nullptr ? new_line : buffer.data() + buffer.size();
+            if (new_line == nullptr && begin == end) {
+                return false;
+            }
+            for (const char* c = begin; c < end; ++c) {
+                if (!std::isspace((unsigned char)*c)) {
+                    line->push_back(*c);
+                }
+            }
+            position = end - buffer.data() + (new_line != nullptr ? 1 : 0);
+            return true;
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + position);
+        position = 0;
+        std::size_t size = buffer.size();
+        buffer.resize(size + IMPORTER_CHUNK_SIZE);
+        ssize_t no_of_read = 0;
+        do {
+            no_of_read = read(fd, buffer.data() + size, IMPORTER_CHUNK_SIZE);
+        } while (no_of_read < 0 && errno == EINTR);
+        buffer.resize(size + (no_of_read > 0 ? no_of_read : 0));
+        at_end = no_of_read <= 0;
+    }
+}
+
+Slitherlink* PuzzleImporter::nextPuzzle(){
+    std::string line;
+    std::vector<std::string> rows;
+    while (getLine(&line)) {
+        if (!line.empty() && line[0] == '#') {
+            continue;
+        }
+        if (line.find(PZPR_PUZZLE_NAME) != std::string::npos) {
+            if (!rows.empty()) {
+                ERROR("URL in the middle of rows");
+                is_good = false;
+                return nullptr;
+            }
+            Slitherlink* slitherlink = importPzprUrl(line.data(), line.data() + line.size());
+            is_good = is_good && slitherlink != nullptr;
+            return slitherlink;
+        }
+        if (line.empty()) {
+            if (rows.empty()) {
+                continue;
+            }
+            break;
+        }
+        rows.push_back(line);
+    }
+    if (rows.empty()) {
+        return nullptr;
+    }
+    Slitherlink* slitherlink = importClueRows(rows);
+    is_good = is_good && slitherlink != nullptr;
+    return slitherlink;
+}
+
+bool PuzzleImporter::isGood(){
+    return is_good;
+}
@@ -1,9 +1,20 @@
 #include "../api/parser.hpp"
+#include "../../../utilities/api/parallel.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-std::size_t convertToBitmap(std::string line){
+std::size_t convertToBitmap(const char* line_begin, const char* line_end){
     std::size_t bitmap = 0;
-    std::size_t value = std::stoi(line);
+    std::ptrdiff_t value = 0;
+    if (!parserReadNumber(&line_begin, line_end, &value)) {
+        ERROR("Can't read bitmap");
+        return 0;
+    }
     std::size_t i = 0;
     while (value > 0){
         if (value % 10) {
@@ -46,168 +57,353 @@ parserState getNextState(parserState current_state, std::size_t params_bitmap){
     return PARSER_STATE_ERROR;
 }
 
-parserState readVertices(std::ifstream* file, std::ptrdiff_t no_of_vertices, std::vector<slitherlink_vertex*>* vertices){
-    std::ptrdiff_t i = 0;
-    std::string line = "";
-    while(i < no_of_vertices){
-        parserGetLine(file, &line);
-        std::istringstream iss(line);
-        std::string word = "";
-        if(!(iss >> word)){
-            ERROR("Can't read vertice no", i);
-            return PARSER_STATE_ERROR;
-        }
-        std::ptrdiff_t id = std::stoi(word);
-        if(id != i){
-            ERROR("Wrong vertice id", id, "expected", i, "in line", line);
-            return PARSER_STATE_ERROR;
-        }
-        if(!(iss >> word)){
-            ERROR("Can't read number of edges of vertice no", i);
-            return PARSER_STATE_ERROR;
-        }
-        std::ptrdiff_t no_of_edges = std::stoi(word);
-        std::ptrdiff_t edge_counter = 0;
-        slitherlink_vertex* vertex = new slitherlink_vertex{
-            .id = i,
-            .no_of_edges = no_of_edges,
-            .edge_ids = {},
-            .edge_refs = {}
-        };
-        while(edge_counter < no_of_edges){
-            if(!(iss >> word)){
-                ERROR("Can't read edge no", edge_counter, "of vertice no", i);
-                return PARSER_STATE_ERROR;
-            }
-            vertex->edge_ids.push_back(std::stoi(word));
-            edge_counter++;
+slitherlink_vertex* parseVertex(const char* line_begin, const char* line_end, std::ptrdiff_t i){
+    std::ptrdiff_t id = 0;
+    if(!parserReadNumber(&line_begin, line_end, &id)){
+        ERROR("Can't read vertice no", i);
+        return nullptr;
+    }
+    if(id != i){
+        ERROR("Wrong vertice id", id, "expected", i);
+        return nullptr;
+    }
+    std::ptrdiff_t no_of_edges = 0;
+    if(!parserReadNumber(&line_begin, line_end, &no_of_edges)){
+        ERROR("Can't read number of edges of vertice no", i);
+        return nullptr;
+    }
+    std::ptrdiff_t edge_counter = 0;
+    slitherlink_vertex* vertex = new slitherlink_vertex{
+        .id = i,
+        .no_of_edges = no_of_edges,
+        .edge_ids = {},
+        .edge_refs = {}
+    };
+    while(edge_counter < no_of_edges){
+        std::ptrdiff_t edge_id = 0;
+        if(!parserReadNumber(&line_begin, line_end, &edge_id)){
+            ERROR("Can't read edge no", edge_counter, "of vertice no", i);
+            delete vertex;
+            return nullptr;
         }
-        vertices->push_back(vertex);
-        i++;
+        vertex->edge_ids.push_back(edge_id);
+        edge_counter++;
     }
-    return PARSER_STATE_READ_LIST_OF_VERTICES;
+    return vertex;
 }
 
-parserState readEdges(std::ifstream* file, std::ptrdiff_t no_of_edges, std::vector<slitherlink_edge*>* edges){
-    std::ptrdiff_t i = 0;
-    std::string line = "";
-    while(i < no_of_edges){
-        parserGetLine(file, &line);
-        std::istringstream iss(line);
-        std::string word = "";
-        if(!(iss >> word)){
-            ERROR("Can't read index of edge no ", i);
-            return PARSER_STATE_ERROR;
-        }
-        std::ptrdiff_t id = std::stoi(word);
-        if(id != i){
-            ERROR("Wrong face id", id, "expected", i);
-            return PARSER_STATE_ERROR;
+slitherlink_edge* parseEdge(const char* line_begin, const char* line_end, std::ptrdiff_t i, bool with_solution){
+    std::ptrdiff_t id = 0;
+    if(!parserReadNumber(&line_begin, line_end, &id)){
+        ERROR("Can't read index of edge no ", i);
+        return nullptr;
+    }
+    if(id != i){
+        ERROR("Wrong face id", id, "expected", i);
+        return nullptr;
+    }
+    std::ptrdiff_t vertex_1_id = 0;
+    if(!parserReadNumber(&line_begin, line_end, &vertex_1_id)){
+        ERROR("Can't read first vertex of edge no ", i);
+        return nullptr;
+    }
+    std::ptrdiff_t vertex_2_id = 0;
+    if(!parserReadNumber(&line_begin, line_end, &vertex_2_id)){
+        ERROR("Can't read second vertex of edge no ", i);
+        return nullptr;
+    }
+    std::ptrdiff_t face_1_id = 0;
+    if(!parserReadNumber(&line_begin, line_end, &face_1_id)){
+        ERROR("Can't read first face of edge no ", i);
+        return nullptr;
+    }
+    std::ptrdiff_t face_2_id = 0;
+    if(!parserReadNumber(&line_begin, line_end, &face_2_id)){
+        ERROR("Can't read second face of edge no ", i);
+        return nullptr;
+    }
+    slitherlink_edge_type solution = EDGE_UNKNOWN;
+    if(with_solution){
+        std::ptrdiff_t solution_value = 0;
+        if(!parserReadNumber(&line_begin, line_end, &solution_value)){
+            ERROR("Can't read solution of edge no ", i);
+            return nullptr;
         }
-        if(!(iss >> word)){
-            ERROR("Can't read first vertex of edge no ", i);
-            return PARSER_STATE_ERROR;
+        if(solution_value < EDGE_IN_SOLUTION || solution_value > EDGE_UNKNOWN){
+            ERROR("Wrong solution", solution_value, "of edge no ", i);
+            return nullptr;
         }
-        std::ptrdiff_t vertex_1_id = std::stoi(word);
-        if(!(iss >> word)){
-            ERROR("Can't read second vertex of edge no ", i);
-            return PARSER_STATE_ERROR;
+        solution = (slitherlink_edge_type)solution_value;
+    }
+    return new slitherlink_edge{
+        .id = i,
+        .vertices = {vertex_1_id, vertex_2_id},
+        .face_ids = {face_1_id, face_2_id},
+        .vertex_refs = {nullptr, nullptr},
+        .face_refs = {nullptr, nullptr},
+        .solution = solution
+    };
+}
+
+slitherlink_face* parseFace(const char* line_begin, const char* line_end, std::ptrdiff_t i){
+    std::ptrdiff_t id = 0;
+    if(!parserReadNumber(&line_begin, line_end, &id)){
+        ERROR("Can't read face no", i);
+        return nullptr;
+    }
+    if(id != i){
+        ERROR("Wrong face id", id, "expected", i);
+        return nullptr;
+    }
+    std::ptrdiff_t value = 0;
+    if(!parserReadNumber(&line_begin, line_end, &value)){
+        ERROR("Can't read value of face no", i);
+        return nullptr;
+    }
+    std::ptrdiff_t no_of_edges = 0;
+    if(!parserReadNumber(&line_begin, line_end, &no_of_edges)){
+        ERROR("Can't read number of edges of face no", i);
+        return nullptr;
+    }
+    std::ptrdiff_t edge_counter = 0;
+    slitherlink_face* face = new slitherlink_face{
+        .id = i,
+        .value = value,
+        .no_of_edges = no_of_edges,
+        .edge_ids = {},
+        .face_ids = {},
+        .edge_refs = {},
+        .face_refs = {}
+    };
+    while(edge_counter < no_of_edges){
+        std::ptrdiff_t edge_id = 0;
+        if(!parserReadNumber(&line_begin, line_end, &edge_id)){
+            ERROR("Can't read edge no", edge_counter, "of face no", i);
+            delete face;
+            return nullptr;
         }
-        std::ptrdiff_t vertex_2_id = std::stoi(word);
-        if(!(iss >> word)){
-            ERROR("Can't read first face of edge no ", i);
+        face->edge_ids.push_back(edge_id);
+        edge_counter++;
+    }
+    return face;
+}
+
+static slitherlink_face* createOuterFace(){
+    return new slitherlink_face{
+        .id = OUTER_FACE,
+        .value = 0,
+        .no_of_edges = 0,
+        .edge_ids = {},
+        .face_ids = {},
+        .edge_refs = {},
+        .face_refs = {}
+    };
+}
+
+parserState readVertices(parser_buffer* buffer, std::ptrdiff_t no_of_vertices, std::vector<slitherlink_vertex*>* vertices){
+    const char* line_begin = nullptr;
+    const char* line_end = nullptr;
+    for(std::ptrdiff_t i = 0; i < no_of_vertices; i++){
+        parserGetLine(buffer, &line_begin, &line_end);
+        slitherlink_vertex* vertex = parseVertex(line_begin, line_end, i);
+        if(vertex == nullptr){
             return PARSER_STATE_ERROR;
         }
-        std::ptrdiff_t face_1_id = std::stoi(word);
-        if(!(iss >> word)){
-            ERROR("Can't read second face of edge no ", i);
+        vertices->push_back(vertex);
+    }
+    return PARSER_STATE_READ_LIST_OF_VERTICES;
+}
+
+parserState readEdges(parser_buffer* buffer, std::ptrdiff_t no_of_edges, std::vector<slitherlink_edge*>* edges, bool with_solution){
+    const char* line_begin = nullptr;
+    const char* line_end = nullptr;
+    for(std::ptrdiff_t i = 0; i < no_of_edges; i++){
+        parserGetLine(buffer, &line_begin, &line_end);
+        slitherlink_edge* edge = parseEdge(line_begin, line_end, i, with_solution);
+        if(edge == nullptr){
             return PARSER_STATE_ERROR;
         }
-        std::ptrdiff_t face_2_id = std::stoi(word);
-        slitherlink_edge* edge = new slitherlink_edge{
-            .id = i,
-            .vertices = {vertex_1_id, vertex_2_id},
-            .face_ids = {face_1_id, face_2_id},
-            .vertex_refs = {nullptr, nullptr},
-            .face_refs = {nullptr, nullptr},
-            .solution = EDGE_UNKNOWN
-        };
         edges->push_back(edge);
-        i++;
     }
-    return PARSER_STATE_READ_LIST_OF_EDGES;
+    return with_solution ? PARSER_STATE_READ_LIST_OF_EDGES_W_SOLVED : PARSER_STATE_READ_LIST_OF_EDGES;
 }
 
-parserState readFaces(std::ifstream* file, std::ptrdiff_t no_of_faces, std::vector<slitherlink_face*>* faces){
-    std::ptrdiff_t i = 0;
-    std::string line = "";
-    while(i < no_of_faces){
-        parserGetLine(file, &line);
-        std::istringstream iss(line);
-        std::string word = "";
-        if(!(iss >> word)){
-            ERROR("Can't read face no", i);
+parserState readFaces(parser_buffer* buffer, std::ptrdiff_t no_of_faces, std::vector<slitherlink_face*>* faces){
+    const char* line_begin = nullptr;
+    const char* line_end = nullptr;
+    for(std::ptrdiff_t i = 0; i < no_of_faces; i++){
+        parserGetLine(buffer, &line_begin, &line_end);
+        slitherlink_face* face = parseFace(line_begin, line_end, i);
+        if(face == nullptr){
             return PARSER_STATE_ERROR;
         }
-        std::ptrdiff_t id = std::stoi(word);
-        if(id != i){
-            ERROR("Wrong face id", id, "expected", i);
-            return PARSER_STATE_ERROR;
+        faces->push_back(face);
+    }
+    // Add outer face
+    faces->push_back(createOuterFace());
+    return PARSER_STATE_READ_LIST_OF_FACES;
+}
+
+/**
+ * Find beginnings of non-comment lines in range, range ends after new line.
+ */
+static void indexLines(const char* begin, const char* end, std::vector<const char*>* lines){
+    while(begin < end){
+        const char* new_line = (const char*)std::memchr(begin, '\n', end - begin);
+        const char* line_end = new_line != nullptr ? new_line : end;
+        if(!isComment(begin, line_end)){
+            lines->push_back(begin);
         }
-        if(!(iss >> word)){
-            ERROR("Can't read value of face no", i);
-            return PARSER_STATE_ERROR;
+        begin = line_end + 1;
+    }
+}
+
+parserState readListsParallel(parser_buffer* buffer,
+                              std::ptrdiff_t no_of_vertices,
+                              std::ptrdiff_t no_of_edges,
+                              std::ptrdiff_t no_of_faces,
+                              bool with_solution,
+                              std::vector<slitherlink_vertex*>* vertices,
+                              std::vector<slitherlink_edge*>* edges,
+                              std::vector<slitherlink_face*>* faces){
+    std::ptrdiff_t no_of_lines = no_of_vertices + no_of_edges + no_of_faces;
+    std::ptrdiff_t no_of_bytes = buffer->end - buffer->current;
+    std::ptrdiff_t no_of_threads = getNoOfThreads(no_of_bytes, PARSER_PARALLEL_MIN_CHUNK);
+    // chunks of text are cut after new lines, then lines are indexed in parallel
+    std::vector<const char*> chunk_begins(no_of_threads + 1, buffer->end);
+    chunk_begins[0] = buffer->current;
+    for(std::ptrdiff_t i = 1; i < no_of_threads; i++){
+        const char* cut = buffer->current + no_of_bytes * i / no_of_threads;
+        cut = std::max(cut, chunk_begins[i - 1]);
+        const char* new_line = (const char*)std::memchr(cut, '\n', buffer->end - cut);
+        chunk_begins[i] = new_line != nullptr ? new_line + 1 : buffer->end;
+    }
+    std::vector<std::vector<const char*>> chunk_lines(no_of_threads);
+    parallelFor(no_of_threads, 1, [&](std::ptrdiff_t begin, std::ptrdiff_t end){
+        for(std::ptrdiff_t i = begin; i < end; i++){
+            indexLines(chunk_begins[i], chunk_begins[i + 1], &chunk_lines[i]);
         }
-        std::ptrdiff_t value = std::stoi(word);
-        if(!(iss >> word)){
-            ERROR("Can't read number of edges of face no", i);
-            return PARSER_STATE_ERROR;
+    });
+    std::vector<const char*> lines;
+    lines.reserve(no_of_lines + 1);
+    for(std::vector<const char*>& chunk : chunk_lines){
+        lines.insert(lines.end(), chunk.begin(), chunk.end());
+        if((std::ptrdiff_t)lines.size() > no_of_lines){
+            break;
         }
-        std::ptrdiff_t no_of_edges = std::stoi(word);
-        std::ptrdiff_t edge_counter = 0;
-        slitherlink_face* face = new slitherlink_face{
-            .id = i,
-            .value = value,
-            .no_of_edges = no_of_edges,
-            .edge_ids = {},
-            .face_ids = {},
-            .edge_refs = {},
-            .face_refs = {}
-        };
-        while(edge_counter < no_of_edges){
-            if(!(iss >> word)){
-                ERROR("Can't read edge no", edge_counter, "of face no", i);
-                return PARSER_STATE_ERROR;
+    }
+    if((std::ptrdiff_t)lines.size() < no_of_lines){
+        ERROR("File has ", lines.size(), " lines of lists, expected ", no_of_lines);
+        return PARSER_STATE_ERROR;
+    }
+
+    vertices->resize(no_of_vertices, nullptr);
+    edges->resize(no_of_edges, nullptr);
+    faces->resize(no_of_faces, nullptr);
+    std::atomic<bool> is_correct(true);
+    parallelFor(no_of_lines, PARSER_PARALLEL_MIN_LINES, [&](std::ptrdiff_t begin, std::ptrdiff_t end){
+        for(std::ptrdiff_t i = begin; i < end && is_correct.load(std::memory_order_relaxed); i++){
+            const char* line_begin = lines[i];
+            const char* new_line = (const char*)std::memchr(line_begin, '\n', buffer->end - line_begin);
+            const char* line_end = new_line != nullptr ? new_line : buffer->end;
+            bool is_parsed = false;
+            if(i < no_of_vertices){
+                (*vertices)[i] = parseVertex(line_begin, line_end, i);
+                is_parsed = (*vertices)[i] != nullptr;
+            }
+            else if(i < no_of_vertices + no_of_edges){
+                std::ptrdiff_t id = i - no_of_vertices;
+                (*edges)[id] = parseEdge(line_begin, line_end, id, with_solution);
+                is_parsed = (*edges)[id] != nullptr;
+            }
+            else{
+                std::ptrdiff_t id = i - no_of_vertices - no_of_edges;
+                (*faces)[id] = parseFace(line_begin, line_end, id);
+                is_parsed = (*faces)[id] != nullptr;
+            }
+            if(!is_parsed){
+                is_correct = false;
             }
-            face->edge_ids.push_back(std::stoi(word));
-            edge_counter++;
         }
-        faces->push_back(face);
-        i++;
+    });
+    if(!is_correct){
+        return PARSER_STATE_ERROR;
+    }
+    faces->push_back(createOuterFace());
+    if((std::ptrdiff_t)lines.size() > no_of_lines){
+        buffer->current = lines[no_of_lines];
+    }
+    else{
+        const char* new_line = (const char*)std::memchr(lines.back(), '\n', buffer->end - lines.back());
+        buffer->current = new_line != nullptr ? new_line + 1 : buffer->end;
     }
-    // Add outer face
-    slitherlink_face* outer_face = new slitherlink_face{
-        .id = OUTER_FACE,
-        .value = 0,
-        .no_of_edges = 0,
-        .edge_ids = {},
-        .face_ids = {},
-        .edge_refs = {},
-        .face_refs = {}
-    };
-    faces->push_back(outer_face);
     return PARSER_STATE_READ_LIST_OF_FACES;
 }
 
-parserState readCoords(std::ifstream* file, std::ptrdiff_t no_of_vertices){
+
+parserState readCoords(parser_buffer* buffer, std::ptrdiff_t no_of_vertices){
     std::ptrdiff_t i = 0;
-    std::string line = "";
-    while(i < no_of_vertices){
-        std::getline(*file, line);
-        if(isComment(line)){
-            continue;
-        }
+    const char* line_begin = nullptr;
+    const char* line_end = nullptr;
+    while(i < no_of_vertices && parserGetLine(buffer, &line_begin, &line_end)){
         i++;
     }
     return PARSER_STATE_READ_LIST_OF_COORDS;
-}
\ No newline at end of file
+}
+
+bool openParserBuffer(const std::string& file_name, parser_buffer* buffer){
+    buffer->mapped_data = nullptr;
+    buffer->mapped_size = 0;
+    buffer->storage.clear();
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd == -1) {
+        ERROR("Can't open file of name: ", file_name);
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        void* data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+            buffer->mapped_data = data;
+            buffer->mapped_size = file_stat.st_size;
+            buffer->begin = (const char*)data;
+            buffer->end = buffer->begin + buffer->mapped_size;
+            buffer->current = buffer->begin;
+            close(fd);
+            return true;
+        }
+    }
+    // not a regular file (e.g. pipe) - read it whole
+    char chunk[1 << 16];
+    ssize_t no_of_read = 0;
+    while ((no_of_read = read(fd, chunk, sizeof(chunk))) > 0) {
+        buffer->storage.append(chunk, no_of_read);
+    }
+    close(fd);
+    buffer->begin = buffer->storage.data();
+    buffer->end = buffer->begin + buffer->storage.size();
+    buffer->current = buffer->begin;
+    return true;
+}
+
+void openParserBufferFromString(std::string text, parser_buffer* buffer){
+    buffer->mapped_data = nullptr;
+    buffer->mapped_size = 0;
+    buffer->storage = std::move(text);
+    buffer->begin = buffer->storage.data();
+    buffer->end = buffer->begin + buffer->storage.size();
+    buffer->current = buffer->begin;
+}
+
+void closeParserBuffer(parser_buffer* buffer){
+    if (buffer->mapped_data != nullptr) {
+        munmap(buffer->mapped_data, buffer->mapped_size);
+        buffer->mapped_data = nullptr;
+        buffer->mapped_size = 0;
+    }
+    buffer->storage.clear();
+    buffer->begin = nullptr;
+    buffer->end = nullptr;
+    buffer->current = nullptr;
+}
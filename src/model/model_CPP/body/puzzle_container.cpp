@@ -0,0 +1,368 @@
+#include "../api/puzzle_container.hpp"
+#include "../../../utilities/api/trace_lib.hpp"
+#include <cstring>
+#include <unistd.h>
+
+static std::uint64_t getPaddedSize(std::uint64_t size){
+    return (size + 7) & ~(std::uint64_t)7;
+}
+
+static std::uint64_t getRecordSize(const container_record_header* header){
+    return sizeof(container_record_header) + getPaddedSize(header->payload_size);
+}
+
+/**
+ * Returns footer of container if it was closed properly, nullptr otherwise.
+ */
+static const container_footer* getFooter(const char* begin, const char* end){
+    std::size_t size = end - begin;
+    if (size < sizeof(container_header) + sizeof(container_footer)) {
+        return nullptr;
+    }
+    const container_footer* footer = (const container_footer*)(end - sizeof(container_footer));
+    if (std::memcmp(footer->magic, CONTAINER_INDEX_MAGIC, sizeof(footer->magic)) != 0 ||
+        footer->index_offset + sizeof(container_record_header) +
+        footer->no_of_puzzles * sizeof(std::uint64_t) > size - sizeof(container_footer)) {
+        return nullptr;
+    }
+    return footer;
+}
+
+/**
+ * Walk records of container, stopping at first truncated or corrupted one.
+ * @return size of valid part of container
+ */
+static std::uint64_t scanRecords(const char* begin,
+                                 const char* end,
+                                 bool check_payload,
+                                 std::vector<std::uint64_t>* puzzle_offsets,
+                                 std::unordered_map<std::uint64_t, std::uint64_t>* topology_offsets){
+    std::uint64_t size = end - begin;
+    std::uint64_t offset = sizeof(container_header);
+    while (offset + sizeof(container_record_header) <= size) {
+        const container_record_header* header = (const container_record_header*)(begin + offset);
+        if (header->payload_size > size - offset - sizeof(container_record_header) ||
+            getRecordSize(header) > size - offset) {
+            break;
+        }
+        const char* payload = begin + offset + sizeof(container_record_header);
+        if (check_payload && getChecksum(payload, header->payload_size) != header->checksum) {
+            ERROR("Corrupted container record at offset ", offset);
+            break;
+        }
+        if (header->type == CONTAINER_RECORD_TOPOLOGY) {
+            if (topology_offsets != nullptr) {
+                (*topology_offsets)[header->reference] = offset;
+            }
+        }
+        else if (header->type == CONTAINER_RECORD_PUZZLE) {
+            if (puzzle_offsets != nullptr) {
+                puzzle_offsets->push_back(offset);
+            }
+        }
+        else if (header->type == CONTAINER_RECORD_INDEX) {
+            // index is rewritten by every writer, it ends valid records
+            break;
+        }
+        else {
+            ERROR("Unknown container record type ", header->type);
+            break;
+        }
+        offset += getRecordSize(header);
+    }
+    return offset;
+}
+
+static bool checkHeader(const char* begin, const char* end){
+    if ((std::size_t)(end - begin) < sizeof(container_header)) {
+        return false;
+    }
+    const container_header* header = (const container_header*)begin;
+    if (std::memcmp(header->magic, CONTAINER_MAGIC, sizeof(header->magic)) != 0) {
+        ERROR("Not a puzzle container");
+        return false;
+    }
+    if (header->version != CONTAINER_VERSION || header->byte_order != BINARY_PUZZLE_BYTE_ORDER) {
+        ERROR("Unsupported container version: ", header->version);
+        return false;
+    }
+    return true;
+}
+
+PuzzleContainerWriter::PuzzleContainerWriter(std::string file_name){
+    file_size = 0;
+    file = std::fopen(file_name.c_str(), "r+b");
+    if (file != nullptr) {
+        std::fclose(file);
+        if (!openExisting(file_name)) {
+            file = nullptr;
+        }
+        return;
+    }
+    file = std::fopen(file_name.c_str(), "w+b");
+    if (file == nullptr) {
+        ERROR("Can't open file of name: ", file_name);
+        return;
+    }
+    container_header header;
+    std::memcpy(header.magic, CONTAINER_MAGIC, sizeof(header.magic));
+    header.version = CONTAINER_VERSION;
+    header.byte_order = BINARY_PUZZLE_BYTE_ORDER;
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        ERROR("Can't write container header: ", file_name);
+        std::fclose(file);
+        file = nullptr;
+        return;
+    }
+    file_size = sizeof(header);
+}
+
+bool PuzzleContainerWriter::openExisting(const std::string& file_name){
+    parser_buffer buffer;
+    if (!openParserBuffer(file_name, &buffer)) {
+        return false;
+    }
+    if (!checkHeader(buffer.begin, buffer.end)) {
+        closeParserBuffer(&buffer);
+        return false;
+    }
+    bool is_closed = getFooter(buffer.begin, buffer.end) != nullptr;
+    file_size = scanRecords(buffer.begin, buffer.end, !is_closed, &puzzle_offsets, &topology_offsets);
+    closeParserBuffer(&buffer);
+    // old index and footer (or broken tail) are overwritten by new records
+    file = std::fopen(file_name.c_str(), "r+b");
+    if (file == nullptr || ftruncate(fileno(file), file_size) != 0 ||
+        std::fseek(file, file_size, SEEK_SET) != 0) {
+        ERROR("Can't open file of name: ", file_name);
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+        return false;
+    }
+    LOG("Appending to container with ", puzzle_offsets.size(), " puzzles");
+    return true;
+}
+
+PuzzleContainerWriter::~PuzzleContainerWriter(){
+    close();
+}
+
+bool PuzzleContainerWriter::isOpen(){
+    return file != nullptr;
+}
+
+bool PuzzleContainerWriter::writeRecord(const container_record_header* header, const char* payload){
+    static const char padding[8] = {0};
+    std::uint64_t padding_size = getPaddedSize(header->payload_size) - header->payload_size;
+    if (std::fwrite(header, sizeof(*header), 1, file) != 1 ||
+        std::fwrite(payload, 1, header->payload_size, file) != header->payload_size ||
+        std::fwrite(padding, 1, padding_size, file) != padding_size) {
+        ERROR("Can't write container record");
+        return false;
+    }
+    file_size += getRecordSize(header);
+    return true;
+}
+
+std::ptrdiff_t PuzzleContainerWriter::append(Slitherlink* puzzle){
+    // serialization is done before taking lock, so workers only wait for writes
+    std::string data;
+    writeBinaryPuzzle(puzzle, &data);
+    binary_puzzle view;
+    if (readBinaryPuzzle(data.data(), data.size(), &view) == 0) {
+        return -1;
+    }
+    std::uint64_t topology_checksum = getTopologyChecksum(&view);
+    const char* values = (const char*)view.face_values;
+    container_record_header puzzle_header = {
+        .type = CONTAINER_RECORD_PUZZLE,
+        .reserved = 0,
+        .payload_size = view.header->no_of_faces + view.header->no_of_edges,
+        .reference = 0,
+        .params_bitmap = puzzle->params_bitmap,
+        .checksum = 0
+    };
+    puzzle_header.checksum = getChecksum(values, puzzle_header.payload_size);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file == nullptr) {
+        return -1;
+    }
+    std::unordered_map<std::uint64_t, std::uint64_t>::iterator topology = topology_offsets.find(topology_checksum);
+    if (topology == topology_offsets.end()) {
+        container_record_header topology_header = {
+            .type = CONTAINER_RECORD_TOPOLOGY,
+            .reserved = 0,
+            .payload_size = data.size(),
+            .reference = topology_checksum,
+            .params_bitmap = puzzle->params_bitmap,
+            .checksum = getChecksum(data.data(), data.size())
+        };
+        std::uint64_t offset = file_size;
+        if (!writeRecord(&topology_header, data.data())) {
+            return -1;
+        }
+        topology = topology_offsets.emplace(topology_checksum, offset).first;
+    }
+    puzzle_header.reference = topology->second;
+    std::uint64_t offset = file_size;
+    if (!writeRecord(&puzzle_header, values)) {
+        return -1;
+    }
+    puzzle_offsets.push_back(offset);
+    return puzzle_offsets.size() - 1;
+}
+
+std::ptrdiff_t PuzzleContainerWriter::getNoOfPuzzles(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return puzzle_offsets.size();
+}
+
+bool PuzzleContainerWriter::close(){
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file == nullptr) {
+        return false;
+    }
+    container_record_header index_header = {
+        .type = CONTAINER_RECORD_INDEX,
+        .reserved = 0,
+        .payload_size = puzzle_offsets.size() * sizeof(std::uint64_t),
+        .reference = 0,
+        .params_bitmap = 0,
+        .checksum = 0
+    };
+    index_header.checksum = getChecksum((const char*)puzzle_offsets.data(), index_header.payload_size);
+    container_footer footer;
+    footer.index_offset = file_size;
+    footer.no_of_puzzles = puzzle_offsets.size();
+    std::memcpy(footer.magic, CONTAINER_INDEX_MAGIC, sizeof(footer.magic));
+    bool result = writeRecord(&index_header, (const char*)puzzle_offsets.data()) &&
+                  std::fwrite(&footer, sizeof(footer), 1, file) == 1;
+    result = std::fclose(file) == 0 && result;
+    file = nullptr;
+    if (!result) {
+        ERROR("Can't write container index");
+    }
+    return result;
+}
+
+PuzzleContainerReader::PuzzleContainerReader(std::string file_name){
+    is_open = false;
+    cursor = sizeof(container_header);
+    if (!openParserBuffer(file_name, &buffer)) {
+        return;
+    }
+    if (!checkHeader(buffer.begin, buffer.end)) {
+        closeParserBuffer(&buffer);
+        return;
+    }
+    is_open = true;
+    const container_footer* footer = getFooter(buffer.begin, buffer.end);
+    if (footer != nullptr) {
+        const std::uint64_t* offsets = (const std::uint64_t*)(buffer.begin + footer->index_offset +
+                                                              sizeof(container_record_header));
+        puzzle_offsets.assign(offsets, offsets + footer->no_of_puzzles);
+    }
+    else {
+        LOG("Container has no index, scanning records");
+        scanRecords(buffer.begin, buffer.end, true, &puzzle_offsets, nullptr);
+    }
+}
+
+PuzzleContainerReader::~PuzzleContainerReader(){
+    if (is_open) {
+        closeParserBuffer(&buffer);
+    }
+}
+
+bool PuzzleContainerReader::isOpen(){
+    return is_open;
+}
+
+std::ptrdiff_t PuzzleContainerReader::getNoOfPuzzles(){
+    return puzzle_offsets.size();
+}
+
+const container_record_header* PuzzleContainerReader::getRecord(std::uint64_t offset){
+    std::uint64_t size = buffer.end - buffer.begin;
+    if (offset % 8 != 0 || offset + sizeof(container_record_header) > size) {
+        return nullptr;
+    }
+    const container_record_header* header = (const container_record_header*)(buffer.begin + offset);
+    if (getRecordSize(header) > size - offset) {
+        return nullptr;
+    }
+    return header;
+}
+
+Slitherlink* PuzzleContainerReader::readPuzzle(std::uint64_t offset){
+    const container_record_header* header = getRecord(offset);
+    if (header == nullptr || header->type != CONTAINER_RECORD_PUZZLE) {
+        ERROR("No puzzle record at offset ", offset);
+        return nullptr;
+    }
+    const char* values = (const char*)(header + 1);
+    if (getChecksum(values, header->payload_size) != header->checksum) {
+        ERROR("Corrupted puzzle record at offset ", offset);
+        return nullptr;
+    }
+    binary_puzzle view;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unordered_map<std::uint64_t, binary_puzzle>::iterator topology = topologies.find(header->reference);
+        if (topology == topologies.end()) {
+            const container_record_header* topology_header = getRecord(header->reference);
+            if (topology_header == nullptr || topology_header->type != CONTAINER_RECORD_TOPOLOGY ||
+                readBinaryPuzzle((const char*)(topology_header + 1), topology_header->payload_size, &view) == 0) {
+                ERROR("No topology record at offset ", header->reference);
+                return nullptr;
+            }
+            topology = topologies.emplace(header->reference, view).first;
+        }
+        view = topology->second;
+    }
+    if (header->payload_size != view.header->no_of_faces + view.header->no_of_edges) {
+        ERROR("Puzzle record does not match its topology at offset ", offset);
+        return nullptr;
+    }
+    view.face_values = (const std::int8_t*)values;
+    view.edge_solutions = view.face_values + view.header->no_of_faces;
+    Slitherlink* puzzle = Slitherlink::loadBinary(&view);
+    if (puzzle == nullptr) {
+        ERROR("Wrong puzzle record at offset ", offset);
+        return nullptr;
+    }
+    puzzle->params_bitmap = header->params_bitmap;
+    return puzzle;
+}
+
+Slitherlink* PuzzleContainerReader::getPuzzle(std::ptrdiff_t id){
+    if (!is_open || id < 0 || id >= (std::ptrdiff_t)puzzle_offsets.size()) {
+        ERROR("No puzzle of id ", id);
+        return nullptr;
+    }
+    return readPuzzle(puzzle_offsets[id]);
+}
+
+Slitherlink* PuzzleContainerReader::nextPuzzle(){
+    if (!is_open) {
+        return nullptr;
+    }
+    const container_record_header* header = nullptr;
+    while ((header = getRecord(cursor)) != nullptr) {
+        std::uint64_t offset = cursor;
+        cursor += getRecordSize(header);
+        if (header->type == CONTAINER_RECORD_PUZZLE) {
+            return readPuzzle(offset);
+        }
+        if (header->type == CONTAINER_RECORD_INDEX) {
+            break;
+        }
+    }
+    cursor = buffer.end - buffer.begin;
+    return nullptr;
+}
+
+void PuzzleContainerReader::rewind(){
+    cursor = sizeof(container_header);
+}
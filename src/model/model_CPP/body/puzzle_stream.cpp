@@ -0,0 +1,186 @@
+#include "../api/puzzle_stream.hpp"
+#include "../api/parser.hpp"
+#include "../api/binary_format.hpp"
+#include "../api/clue_format.hpp"
+#include "../../../utilities/api/trace_lib.hpp"
+#include <cerrno>
+#include <unistd.h>
+
+bool getPuzzleFormat(const std::string& name, puzzle_format* format){
+    if (name == "text") {
+        *format = PUZZLE_FORMAT_TEXT;
+    }
+    else if (name == "binary") {
+        *format = PUZZLE_FORMAT_BINARY;
+    }
+    else if (name == "clue") {
+        *format = PUZZLE_FORMAT_CLUE;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+bool writePuzzle(Slitherlink* slitherlink, puzzle_format format, BufferedWriter* writer){
+    std::string data;
+    bool is_solved = true;
+    switch (format) {
+        case PUZZLE_FORMAT_TEXT:
+            slitherlink->printPuzzle(writer);
+            return true;
+        case PUZZLE_FORMAT_BINARY:
+            writeBinaryPuzzle(slitherlink, &data);
+            break;
+        case PUZZLE_FORMAT_CLUE:
+            // clue records keep only complete solutions
+            for (slitherlink_edge* edge : slitherlink->edges) {
+                is_solved = is_solved && edge->solution != EDGE_UNKNOWN;
+            }
+            if (!writeCluePuzzle(slitherlink, is_solved, &data)) {
+                return false;
+            }
+            break;
+    }
+    writer->write(data);
+    return true;
+}
+
+/**
+ * Find end of text record, counting its lines.
+ * @return size of record, 0 if it is not complete
+ */
+static std::size_t getTextRecordSize(const char* begin, const char* end, bool at_end){
+    parser_buffer view;
+    view.begin = begin;
+    view.end = end;
+    view.current = begin;
+    const char* line_begin = nullptr;
+    const char* line_end = nullptr;
+    std::ptrdiff_t no_of_lines = 0;
+    std::ptrdiff_t no_of_read = 0;
+    std::size_t params_bitmap = 0;
+    while (no_of_read == 0 || no_of_read < no_of_lines) {
+        if (!parserGetLine(&view, &line_begin, &line_end) || (line_end == end && !at_end)) {
+            return 0;
+        }
+        std::ptrdiff_t value = 0;
+        if (no_of_read == 0) {
+            params_bitmap = convertToBitmap(line_begin, line_end);
+            no_of_lines = 4 + ((params_bitmap & TYPE_OF_GRID_PRESENT) ? 1 : 0);
+        }
+        else if (no_of_read <= 3) {
+            if (!parserReadNumber(&line_begin, line_end, &value) || value < 0) {
+                return 0;
+            }
+            no_of_lines += value;
+        }
+        ++no_of_read;
+    }
+    return view.current - begin;
+}
+
+PuzzleStreamReader::PuzzleStreamReader(int fd){
+    this->fd = fd;
+    this->no_of_used = 0;
+    this->at_end = false;
+    this->is_good = true;
+}
+
+bool PuzzleStreamReader::readChunk(){
+    if (at_end) {
+        return false;
+    }
+    // chunks grow with buffer, so big records are not framed again for every chunk
+    std::size_t size = buffer.size();
+    std::size_t chunk_size = size > PUZZLE_STREAM_CHUNK_SIZE ? size : PUZZLE_STREAM_CHUNK_SIZE;
+    buffer.resize(size + chunk_size);
+    ssize_t no_of_read = 0;
+    do {
+        no_of_read = read(fd, buffer.data() + size, chunk_size);
+    } while (no_of_read < 0 && errno == EINTR);
+    buffer.resize(size + (no_of_read > 0 ? no_of_read : 0));
+    if (no_of_read <= 0) {
+        at_end = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @return size of first record in buffer, 0 if it is not complete yet
+ */
+std::size_t PuzzleStreamReader::getRecordSize(){
+    const char* begin = buffer.data();
+    std::size_t size = buffer.size();
+    if (isBinaryPuzzle(begin, size)) {
+        if (size < sizeof(binary_puzzle_header)) {
+            return 0;
+        }
+        const binary_puzzle_header* header = (const binary_puzzle_header*)begin;
+        std::size_t record_size = sizeof(binary_puzzle_header) + header->payload_size;
+        return record_size <= size ? record_size : 0;
+    }
+    if (isCluePuzzle(begin, size)) {
+        if (size < sizeof(clue_record_header)) {
+            return 0;
+        }
+        clue_record_header header;
+        std::memcpy(&header, begin, sizeof(header));
+        std::size_t record_size = getClueRecordSize(&header);
+        if (record_size == 0) {
+            // header alone is passed on, so that loading reports it
+            return sizeof(clue_record_header);
+        }
+        return record_size <= size ? record_size : 0;
+    }
+    if (size < BINARY_PUZZLE_MAGIC_SIZE && !at_end) {
+        return 0;
+    }
+    return getTextRecordSize(begin, begin + size, at_end);
+}
+
+Slitherlink* PuzzleStreamReader::nextPuzzle(){
+    // consumed record is dropped, so next one starts aligned at buffer begin
+    buffer.erase(buffer.begin(), buffer.begin() + no_of_used);
+    no_of_used = 0;
+    std::size_t record_size = 0;
+    while ((record_size = getRecordSize()) == 0) {
+        if (!readChunk()) {
+            // only whitespace and comments may follow last record
+            const char* line_begin = nullptr;
+            const char* line_end = nullptr;
+            parser_buffer view;
+            view.begin = buffer.data();
+            view.end = buffer.data() + buffer.size();
+            view.current = view.begin;
+            while (parserGetLine(&view, &line_begin, &line_end)) {
+                for (const char* c = line_begin; c < line_end; ++c) {
+                    if (!std::isspace((unsigned char)*c)) {
+                        ERROR("Stream ended in the middle of puzzle");
+                        is_good = false;
+                        return nullptr;
+                    }
+                }
+            }
+            return nullptr;
+        }
+    }
+    parser_buffer view;
+    view.begin = buffer.data();
+    view.end = buffer.data() + record_size;
+    view.current = view.begin;
+    view.mapped_data = nullptr;
+    view.mapped_size = 0;
+    no_of_used = record_size;
+    Slitherlink* puzzle = Slitherlink::load(&view);
+    if (puzzle == nullptr) {
+        ERROR("Wrong puzzle in stream");
+        is_good = false;
+    }
+    return puzzle;
+}
+
+bool PuzzleStreamReader::isGood(){
+    return is_good;
+}
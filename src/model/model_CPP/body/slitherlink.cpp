@@ -1,59 +1,98 @@
 #include "../api/slitherlink.hpp"
 #include "../api/parser.hpp"
+#include "../api/binary_format.hpp"
+#include "../api/clue_format.hpp"
+#include "../api/topology_cache.hpp"
 #include "../../../utilities/api/trace_lib.hpp"
+#include "../../../utilities/api/buffered_writer.hpp"
+#include "../../../utilities/api/parallel.hpp"
+#include <atomic>
 #include <fstream>
 #include <cassert>
 #include <bitset>
+#include <fcntl.h>
+#include <unistd.h>
 
-static int readDataFromFile(std::string file_name,
-                            Slitherlink* slitherlink){
-    LOG("Reading data from file: ", file_name);
-    std::ifstream file(file_name);
-    if (!file) {
-        ERROR("Can't open file of name: ", file_name);
-    }
-
-    std::string line = "";
+static int readTextFromBuffer(parser_buffer* buffer,
+                              Slitherlink* slitherlink){
+    const char* line_begin = nullptr;
+    const char* line_end = nullptr;
+    std::ptrdiff_t value = 0;
     parserState state = PARSER_STATE_DEFAULT;
     std::size_t params_bitmap = 0;
     while(state != PARSER_STATE_FINISH && state != PARSER_STATE_ERROR){
         LOG_DEBUG("Current state: ", state);
         switch(state){
             case PARSER_STATE_DEFAULT:
-                parserGetLine(&file, &line);
-                params_bitmap = convertToBitmap(line);
+                parserGetLine(buffer, &line_begin, &line_end);
+                params_bitmap = convertToBitmap(line_begin, line_end);
                 slitherlink->params_bitmap = params_bitmap;
                 if((params_bitmap & SOLVER_PARAMS_REQUIRED) ^ SOLVER_PARAMS_REQUIRED){
-                    ERROR("Missing parameters in file: ", file_name, " bitmap: ", params_bitmap);
+                    ERROR("Missing parameters in file, bitmap: ", params_bitmap);
                     state = PARSER_STATE_ERROR;
                 }
                 state = getNextState(state, params_bitmap);
                 break;
             case PARSER_STATE_READ_V:
-                parserGetLine(&file, &line);
-                slitherlink->no_of_vertices = std::stoi(line);
+                parserGetLine(buffer, &line_begin, &line_end);
+                if (!parserReadNumber(&line_begin, line_end, &value)) {
+                    ERROR("Can't read number of vertices");
+                    state = PARSER_STATE_ERROR;
+                    break;
+                }
+                slitherlink->no_of_vertices = value;
                 state = getNextState(state, params_bitmap);
                 break;
             case PARSER_STATE_READ_E:
-                parserGetLine(&file, &line);
-                slitherlink->no_of_edges = std::stoi(line);
+                parserGetLine(buffer, &line_begin, &line_end);
+                if (!parserReadNumber(&line_begin, line_end, &value)) {
+                    ERROR("Can't read number of edges");
+                    state = PARSER_STATE_ERROR;
+                    break;
+                }
+                slitherlink->no_of_edges = value;
                 state = getNextState(state, params_bitmap);
                 break;
             case PARSER_STATE_READ_F:
-                parserGetLine(&file, &line);
-                slitherlink->no_of_faces = std::stoi(line);
+                parserGetLine(buffer, &line_begin, &line_end);
+                if (!parserReadNumber(&line_begin, line_end, &value)) {
+                    ERROR("Can't read number of faces");
+                    state = PARSER_STATE_ERROR;
+                    break;
+                }
+                slitherlink->no_of_faces = value;
                 state = getNextState(state, params_bitmap);
                 break;
             case PARSER_STATE_READ_LIST_OF_VERTICES:
-                state = readVertices(&file, slitherlink->no_of_vertices, &slitherlink->vertices);
+                if (slitherlink->no_of_vertices + slitherlink->no_of_edges + slitherlink->no_of_faces
+                        >= PARSER_PARALLEL_MIN_LINES) {
+                    state = readListsParallel(buffer,
+                                              slitherlink->no_of_vertices,
+                                              slitherlink->no_of_edges,
+                                              slitherlink->no_of_faces,
+                                              params_bitmap & SOLVED_EDGE_BIT_PRESENT,
+                                              &slitherlink->vertices,
+                                              &slitherlink->edges,
+                                              &slitherlink->faces);
+                    if (state == PARSER_STATE_READ_LIST_OF_FACES) {
+                        slitherlink->no_of_faces += 1;
+                    }
+                    state = getNextState(state, params_bitmap);
+                    break;
+                }
+                state = readVertices(buffer, slitherlink->no_of_vertices, &slitherlink->vertices);
                 state = getNextState(state, params_bitmap);
                 break;
             case PARSER_STATE_READ_LIST_OF_EDGES:
-                state = readEdges(&file, slitherlink->no_of_edges, &slitherlink->edges);
+                state = readEdges(buffer, slitherlink->no_of_edges, &slitherlink->edges, false);
+                state = getNextState(state, params_bitmap);
+                break;
+            case PARSER_STATE_READ_LIST_OF_EDGES_W_SOLVED:
+                state = readEdges(buffer, slitherlink->no_of_edges, &slitherlink->edges, true);
                 state = getNextState(state, params_bitmap);
                 break;
             case PARSER_STATE_READ_LIST_OF_FACES:
-                state = readFaces(&file, slitherlink->no_of_faces, &slitherlink->faces);
+                state = readFaces(buffer, slitherlink->no_of_faces, &slitherlink->faces);
                 slitherlink->no_of_faces += 1;
                 state = getNextState(state, params_bitmap);
                 break;
@@ -64,105 +103,198 @@ static int readDataFromFile(std::string file_name,
                 break;
         }
     }
-    file.close();
     if (state == PARSER_STATE_ERROR) {
-        ERROR("Error while reading file: ", file_name);
         return -1;
     }
     return 0;
 }
 
+/**
+ * Elements per thread when references are evaluated in parallel.
+ */
+#define REFERENCES_PARALLEL_MIN_CHUNK   (1 << 16)
+
+/**
+ * Read puzzle in any format, recognized by its magic.
+ */
+static int readDataFromBuffer(parser_buffer* buffer,
+                              Slitherlink* slitherlink){
+    std::size_t size = buffer->end - buffer->current;
+    if (isBinaryPuzzle(buffer->current, size)) {
+        binary_puzzle puzzle;
+        std::size_t puzzle_size = readBinaryPuzzle(buffer->current, size, &puzzle);
+        if (puzzle_size == 0) {
+            return -1;
+        }
+        buffer->current += puzzle_size;
+        return loadBinaryPuzzle(&puzzle, slitherlink);
+    }
+    if (isCluePuzzle(buffer->current, size)) {
+        std::size_t puzzle_size = loadCluePuzzle(buffer->current, size, slitherlink);
+        if (puzzle_size == 0) {
+            return -1;
+        }
+        buffer->current += puzzle_size;
+        return 0;
+    }
+    return readTextFromBuffer(buffer, slitherlink);
+}
+
+static int readDataFromFile(std::string file_name,
+                            Slitherlink* slitherlink){
+    LOG("Reading data from file: ", file_name);
+    parser_buffer buffer;
+    if (!openParserBuffer(file_name, &buffer)) {
+        return -1;
+    }
+    int result = readDataFromBuffer(&buffer, slitherlink);
+    closeParserBuffer(&buffer);
+    if (result != 0) {
+        ERROR("Error while reading file: ", file_name);
+    }
+    return result;
+}
+
+static bool isIdInRange(std::ptrdiff_t id, std::ptrdiff_t min, std::ptrdiff_t max){
+    return id >= min && id < max;
+}
+
 int Slitherlink::evaluateReferences(){
     LOG_DEBUG("Evaluating references");
+    // every element only writes its own references, so chunks are independent
+    std::atomic<bool> is_correct(true);
     LOG_DEBUG("Vertex references");
     // Vertex references
-    for (slitherlink_vertex* vertex : vertices) {
-        LOG_DEBUG("Vertex ", vertex->id);
-        vertex->edge_refs.clear();
-        for (std::ptrdiff_t edge_id : vertex->edge_ids) {
-            LOG_DEBUG("Edge ", edge_id);
-            if (edge_id >= no_of_edges) {
-                ERROR("Vertex ", vertex->id, " references non-existing edge ", edge_id);
-                return -1;
+    parallelFor(no_of_vertices, REFERENCES_PARALLEL_MIN_CHUNK, [&](std::ptrdiff_t begin, std::ptrdiff_t end){
+        for (std::ptrdiff_t i = begin; i < end; ++i) {
+            slitherlink_vertex* vertex = vertices[i];
+            LOG_DEBUG("Vertex ", vertex->id);
+            vertex->edge_refs.clear();
+            for (std::ptrdiff_t edge_id : vertex->edge_ids) {
+                LOG_DEBUG("Edge ", edge_id);
+                if (!isIdInRange(edge_id, 0, no_of_edges)) {
+                    ERROR("Vertex ", vertex->id, " references non-existing edge ", edge_id);
+                    is_correct = false;
+                    return;
+                }
+                vertex->edge_refs.push_back(edges[edge_id]);
             }
-            vertex->edge_refs.push_back(edges[edge_id]);
         }
+    });
+    if (!is_correct) {
+        return -1;
     }
     LOG_DEBUG("Edge references");
     // Edge references
-    for (slitherlink_edge* edge : edges) {
-        std::ptrdiff_t vertex_id = edge->vertices[0];
-        if (vertex_id >= no_of_vertices) {
-            ERROR("Edge ", edge->id, " references non-existing vertex ", vertex_id);
-            return -1;
-        }
-        edge->vertex_refs[0] = vertices[vertex_id];
-        vertex_id = edge->vertices[1];
-        if (vertex_id >= no_of_vertices) {
-            ERROR("Edge ", edge->id, " references non-existing vertex ", vertex_id);
-            return -1;
-        }
-        edge->vertex_refs[1] = vertices[vertex_id];
-
-        std::ptrdiff_t face_id = edge->face_ids[0];
-        if (face_id >= no_of_faces) {
-            ERROR("Edge ", edge->id, " references non-existing face ", face_id);
-            return -1;
-        }
-        else if (face_id == OUTER_FACE) {
-            edge->face_refs[0] = faces[no_of_faces - 1];
-        }
-        else {
-            edge->face_refs[0] = faces[face_id];
-        }
-        face_id = edge->face_ids[1];
-        if (face_id >= no_of_faces) {
-            ERROR("Edge ", edge->id, " references non-existing face ", face_id);
-            return -1;
-        }
-        else if (face_id == OUTER_FACE) {
-            edge->face_refs[1] = faces[no_of_faces - 1];
-        }
-        else {
-            edge->face_refs[1] = faces[face_id];
+    parallelFor(no_of_edges, REFERENCES_PARALLEL_MIN_CHUNK, [&](std::ptrdiff_t begin, std::ptrdiff_t end){
+        for (std::ptrdiff_t i = begin; i < end; ++i) {
+            slitherlink_edge* edge = edges[i];
+            for (int j = 0; j < 2; ++j) {
+                std::ptrdiff_t vertex_id = edge->vertices[j];
+                if (!isIdInRange(vertex_id, 0, no_of_vertices)) {
+                    ERROR("Edge ", edge->id, " references non-existing vertex ", vertex_id);
+                    is_correct = false;
+                    return;
+                }
+                edge->vertex_refs[j] = vertices[vertex_id];
+            }
+            for (int j = 0; j < 2; ++j) {
+                std::ptrdiff_t face_id = edge->face_ids[j];
+                if (!isIdInRange(face_id, OUTER_FACE, no_of_faces)) {
+                    ERROR("Edge ", edge->id, " references non-existing face ", face_id);
+                    is_correct = false;
+                    return;
+                }
+                else if (face_id == OUTER_FACE) {
+                    edge->face_refs[j] = faces[no_of_faces - 1];
+                }
+                else {
+                    edge->face_refs[j] = faces[face_id];
+                }
+            }
         }
+    });
+    if (!is_correct) {
+        return -1;
     }
     LOG_DEBUG("Face references");
     // Face references
-    for (slitherlink_face* face : faces) {
-        if (face->id == OUTER_FACE) {
-            continue;
-        }
-        face->edge_refs.clear();
-        face->face_refs.clear();
-        for (std::ptrdiff_t edge_id : face->edge_ids) {
-            if (edge_id >= no_of_edges) {
-                ERROR("Face ", face->id, " references non-existing edge ", edge_id);
-                return -1;
+    parallelFor(no_of_faces, REFERENCES_PARALLEL_MIN_CHUNK, [&](std::ptrdiff_t begin, std::ptrdiff_t end){
+        for (std::ptrdiff_t i = begin; i < end; ++i) {
+            slitherlink_face* face = faces[i];
+            if (face->id == OUTER_FACE) {
+                continue;
             }
-            face->edge_refs.push_back(edges[edge_id]);
-            std::ptrdiff_t face_id = edges[edge_id]->face_ids[0] == face->id ?
-                                        edges[edge_id]->face_ids[1] :
-                                        edges[edge_id]->face_ids[0];
-            face->face_ids.push_back(face_id);
-            if (face_id == OUTER_FACE) {
-                face->face_refs.push_back(faces[no_of_faces - 1]);
-            }
-            else if (face_id >= no_of_faces) {
-                ERROR("Face ", face->id, " references non-existing face ", face_id);
-                return -1;
-            }
-            else {
-                face->face_refs.push_back(faces[face_id]);
+            face->edge_refs.clear();
+            face->face_refs.clear();
+            for (std::ptrdiff_t edge_id : face->edge_ids) {
+                if (!isIdInRange(edge_id, 0, no_of_edges)) {
+                    ERROR("Face ", face->id, " references non-existing edge ", edge_id);
+                    is_correct = false;
+                    return;
+                }
+                face->edge_refs.push_back(edges[edge_id]);
+                std::ptrdiff_t face_id = edges[edge_id]->face_ids[0] == face->id ?
+                                            edges[edge_id]->face_ids[1] :
+                                            edges[edge_id]->face_ids[0];
+                face->face_ids.push_back(face_id);
+                if (face_id == OUTER_FACE) {
+                    face->face_refs.push_back(faces[no_of_faces - 1]);
+                }
+                else if (!isIdInRange(face_id, 0, no_of_faces)) {
+                    ERROR("Face ", face->id, " references non-existing face ", face_id);
+                    is_correct = false;
+                    return;
+                }
+                else {
+                    face->face_refs.push_back(faces[face_id]);
+                }
             }
         }
-    }
-    return 0;
+    });
+    return is_correct ? 0 : -1;
 }
 
 Slitherlink::Slitherlink(std::string file_name){
-    assert(readDataFromFile(file_name, this) == 0);
-    assert(this->evaluateReferences() == 0);
+    int result = readDataFromFile(file_name, this);
+    assert(result == 0);
+    result = this->evaluateReferences();
+    assert(result == 0);
+    (void)result;
+}
+
+Slitherlink::Slitherlink(parser_buffer* buffer){
+    int result = readDataFromBuffer(buffer, this);
+    assert(result == 0);
+    result = this->evaluateReferences();
+    assert(result == 0);
+    (void)result;
+}
+
+Slitherlink* Slitherlink::load(parser_buffer* buffer){
+    Slitherlink* slitherlink = new Slitherlink();
+    if (readDataFromBuffer(buffer, slitherlink) != 0 || slitherlink->evaluateReferences() != 0) {
+        delete slitherlink;
+        return nullptr;
+    }
+    return slitherlink;
+}
+
+Slitherlink::Slitherlink(const binary_puzzle* puzzle){
+    int result = loadBinaryPuzzle(puzzle, this);
+    assert(result == 0);
+    result = this->evaluateReferences();
+    assert(result == 0);
+    (void)result;
+}
+
+Slitherlink* Slitherlink::loadBinary(const binary_puzzle* puzzle){
+    Slitherlink* slitherlink = new Slitherlink();
+    if (loadBinaryPuzzle(puzzle, slitherlink) != 0 || slitherlink->evaluateReferences() != 0) {
+        delete slitherlink;
+        return nullptr;
+    }
+    return slitherlink;
 }
 
 Slitherlink::Slitherlink(std::size_t params_bitmap,
@@ -179,7 +311,24 @@ Slitherlink::Slitherlink(std::size_t params_bitmap,
     this->vertices = vertices;
     this->edges = edges;
     this->faces = faces;
-    assert(this->evaluateReferences() == 0);
+    int result = this->evaluateReferences();
+    assert(result == 0);
+    (void)result;
+}
+
+Slitherlink::Slitherlink(std::ptrdiff_t size){
+    copyElements(getBlankTopology(GRID_HEXAGONAL, size));
+}
+
+Slitherlink::Slitherlink(std::ptrdiff_t width, std::ptrdiff_t height){
+    copyElements(getBlankTopology(GRID_SQUARE, width, height));
+}
+
+Slitherlink::Slitherlink(){
+    params_bitmap = 0;
+    no_of_vertices = 0;
+    no_of_edges = 0;
+    no_of_faces = 0;
 }
 
 Slitherlink::~Slitherlink(){
@@ -194,76 +343,151 @@ Slitherlink::~Slitherlink(){
     }
 }
 
-Slitherlink* Slitherlink::copy(){
-    std::vector<slitherlink_vertex*> vertices_copy = std::vector<slitherlink_vertex*>();
-    std::vector<slitherlink_edge*> edges_copy = std::vector<slitherlink_edge*>();
-    std::vector<slitherlink_face*> faces_copy = std::vector<slitherlink_face*>();
-
+void Slitherlink::copyElements(const Slitherlink* other){
+    params_bitmap = other->params_bitmap;
+    no_of_vertices = other->no_of_vertices;
+    no_of_edges = other->no_of_edges;
+    no_of_faces = other->no_of_faces;
+    vertices.resize(no_of_vertices);
+    edges.resize(no_of_edges);
+    faces.resize(no_of_faces);
+    // elements are allocated first, so references can point to any of them
+    for (std::ptrdiff_t i = 0; i < no_of_vertices; ++i) {
+        vertices[i] = new slitherlink_vertex(*other->vertices[i]);
+    }
+    for (std::ptrdiff_t i = 0; i < no_of_edges; ++i) {
+        edges[i] = new slitherlink_edge(*other->edges[i]);
+    }
+    for (std::ptrdiff_t i = 0; i < no_of_faces; ++i) {
+        faces[i] = new slitherlink_face(*other->faces[i]);
+    }
+    // outer face is the last one
+    auto getFace = [&](const slitherlink_face* face){
+        return face->id == OUTER_FACE ? faces[no_of_faces - 1] : faces[face->id];
+    };
     for (slitherlink_vertex* vertex : vertices) {
-        vertices_copy.push_back(new slitherlink_vertex(*vertex));
+        for (slitherlink_edge*& edge : vertex->edge_refs) {
+            edge = edges[edge->id];
+        }
     }
     for (slitherlink_edge* edge : edges) {
-        edges_copy.push_back(new slitherlink_edge(*edge));
+        for (int j = 0; j < 2; ++j) {
+            edge->vertex_refs[j] = vertices[edge->vertex_refs[j]->id];
+            edge->face_refs[j] = getFace(edge->face_refs[j]);
+        }
     }
     for (slitherlink_face* face : faces) {
-        faces_copy.push_back(new slitherlink_face(*face));
+        for (slitherlink_edge*& edge : face->edge_refs) {
+            edge = edges[edge->id];
+        }
+        for (slitherlink_face*& neighbour : face->face_refs) {
+            neighbour = getFace(neighbour);
+        }
     }
-    return new Slitherlink(params_bitmap,
-                           no_of_vertices,
-                           no_of_edges,
-                           no_of_faces,
-                           vertices_copy,
-                           edges_copy,
-                           faces_copy);
+}
+
+Slitherlink* Slitherlink::copy() const{
+    Slitherlink* slitherlink = new Slitherlink();
+    slitherlink->copyElements(this);
+    return slitherlink;
 }
 
 void Slitherlink::printPuzzle(std::ofstream* ofstream){
-    *ofstream << "# Bitmap" << std::endl;
-    *ofstream << std::bitset<NO_OF_PARAMS>(params_bitmap) << std::endl;
-    *ofstream << "# No of vertices: " << std::endl;
-    *ofstream << no_of_vertices << std::endl;
-    *ofstream << "# No of edges: " << std::endl;
-    *ofstream << no_of_edges << std::endl;
-    *ofstream << "# No of faces: " << std::endl;
-    *ofstream << no_of_faces - 1 << std::endl;
-    *ofstream << "# Vertices: " << std::endl;
+    BufferedWriter writer(ofstream);
+    printPuzzle(&writer);
+}
+
+void Slitherlink::printPuzzle(BufferedWriter* writer){
+    writer->write("# Bitmap\n");
+    writer->write(std::bitset<NO_OF_PARAMS>(params_bitmap).to_string());
+    writer->write("\n# No of vertices: \n");
+    writer->writeNumber(no_of_vertices);
+    writer->write("\n# No of edges: \n");
+    writer->writeNumber(no_of_edges);
+    writer->write("\n# No of faces: \n");
+    writer->writeNumber(no_of_faces - 1);
+    writer->write("\n# Vertices: \n");
     for (slitherlink_vertex* vertex : vertices) {
-        *ofstream << vertex->id << " ";
-        *ofstream << vertex->no_of_edges << " ";
+        writer->writeNumber(vertex->id);
+        writer->write(' ');
+        writer->writeNumber(vertex->no_of_edges);
+        writer->write(' ');
         for (slitherlink_edge* edge : vertex->edge_refs) {
-            *ofstream << edge->id << " ";
+            writer->writeNumber(edge->id);
+            writer->write(' ');
         }
-        *ofstream << std::endl;
+        writer->write('\n');
     }
-    *ofstream << "# Edges: " << std::endl;
+    writer->write("# Edges: \n");
     for (slitherlink_edge* edge : edges) {
-        *ofstream << edge->id << " ";
-        *ofstream << edge->vertices[0] << " " << edge->vertices[1] << " ";
-        *ofstream << edge->face_ids[0] << " " << edge->face_ids[1];
-        *ofstream << " " << edge->solution;
-        *ofstream << std::endl;
+        writer->writeNumber(edge->id);
+        writer->write(' ');
+        writer->writeNumber(edge->vertices[0]);
+        writer->write(' ');
+        writer->writeNumber(edge->vertices[1]);
+        writer->write(' ');
+        writer->writeNumber(edge->face_ids[0]);
+        writer->write(' ');
+        writer->writeNumber(edge->face_ids[1]);
+        writer->write(' ');
+        writer->writeNumber(edge->solution);
+        writer->write('\n');
     }
-    *ofstream << "# Faces: ";
+    writer->write("# Faces: ");
     for (slitherlink_face* face : faces) {
-        *ofstream << std::endl;
+        writer->write('\n');
         if (face->id == OUTER_FACE) {
             continue;
         }
-        *ofstream << face->id << " ";
-        *ofstream << face->value << " ";
-        *ofstream << face->no_of_edges;
-        for (std::size_t edge_id : face->edge_ids) {
-            *ofstream << " " << edge_id;
+        writer->writeNumber(face->id);
+        writer->write(' ');
+        writer->writeNumber(face->value);
+        writer->write(' ');
+        writer->writeNumber(face->no_of_edges);
+        for (std::ptrdiff_t edge_id : face->edge_ids) {
+            writer->write(' ');
+            writer->writeNumber(edge_id);
         }
     }
 }
 
 void Slitherlink::savePuzzle(std::string file_name){
-    std::ofstream file(file_name);
+    int fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        ERROR("Can't open file of name: ", file_name);
+        return;
+    }
+    BufferedWriter writer(fd);
+    printPuzzle(&writer);
+    if (!writer.flush()) {
+        ERROR("Can't write file of name: ", file_name);
+    }
+    close(fd);
+}
+
+void Slitherlink::saveBinaryPuzzle(std::string file_name){
+    std::string data;
+    writeBinaryPuzzle(this, &data);
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file) {
+        ERROR("Can't open file of name: ", file_name);
+        return;
+    }
+    file.write(data.data(), data.size());
+    file.close();
+}
+
+void Slitherlink::saveCluePuzzle(std::string file_name, bool with_solution){
+    std::string data;
+    if (!writeCluePuzzle(this, with_solution, &data)) {
+        return;
+    }
+    std::ofstream file(file_name, std::ios::binary);
     if (!file) {
         ERROR("Can't open file of name: ", file_name);
+        return;
     }
-    printPuzzle(&file);
+    file.write(data.data(), data.size());
     file.close();
 }
 
@@ -0,0 +1,280 @@
+#include "../api/solution_set.hpp"
+#include "../api/binary_format.hpp"
+#include "../../../utilities/api/trace_lib.hpp"
+#include <cstring>
+
+static void appendVarint(std::vector<std::uint8_t>* data, std::uint64_t value){
+    while (value >= 0x80) {
+        data->push_back((std::uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    data->push_back((std::uint8_t)value);
+}
+
+/**
+ * @return false if varint does not end before end
+ */
+static bool readVarint(const std::uint8_t** current, const std::uint8_t* end, std::uint64_t* value){
+    *value = 0;
+    for (int shift = 0; *current < end && shift < 64; shift += 7) {
+        std::uint8_t byte = *(*current)++;
+        *value |= (std::uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SolutionSetWriter::SolutionSetWriter(std::string file_name,
+                                     std::ptrdiff_t no_of_edges,
+                                     std::ptrdiff_t keyframe_interval){
+    std::memcpy(header.magic, SOLUTION_SET_MAGIC, sizeof(header.magic));
+    header.version = SOLUTION_SET_VERSION;
+    header.byte_order = BINARY_PUZZLE_BYTE_ORDER;
+    header.no_of_edges = no_of_edges;
+    header.no_of_solutions = 0;
+    header.keyframe_interval = keyframe_interval > 0 ? keyframe_interval : 1;
+    header.index_offset = 0;
+    header.checksum = CHECKSUM_OFFSET_BASIS;
+    previous.assign((no_of_edges + 7) / 8, 0);
+    current.assign((no_of_edges + 7) / 8, 0);
+    file_size = 0;
+    file = std::fopen(file_name.c_str(), "wb");
+    if (file == nullptr) {
+        ERROR("Can't open file of name: ", file_name);
+        return;
+    }
+    // header is written again with counts on close
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        ERROR("Can't write file of name: ", file_name);
+        std::fclose(file);
+        file = nullptr;
+        return;
+    }
+    file_size = sizeof(header);
+}
+
+SolutionSetWriter::~SolutionSetWriter(){
+    close();
+}
+
+bool SolutionSetWriter::isOpen(){
+    return file != nullptr;
+}
+
+bool SolutionSetWriter::write(const void* data, std::size_t size){
+    if (std::fwrite(data, 1, size, file) != size) {
+        ERROR("Can't write solution set");
+        return false;
+    }
+    header.checksum = updateChecksum(header.checksum, (const char*)data, size);
+    file_size += size;
+    return true;
+}
+
+bool SolutionSetWriter::append(Slitherlink* solution){
+    if (file == nullptr || solution->no_of_edges != (std::ptrdiff_t)header.no_of_edges) {
+        return false;
+    }
+    std::fill(current.begin(), current.end(), 0);
+    for (std::ptrdiff_t i = 0; i < solution->no_of_edges; ++i) {
+        if (solution->edges[i]->solution == EDGE_IN_SOLUTION) {
+            current[i / 8] |= (std::uint8_t)(1 << (i % 8));
+        }
+    }
+    record.clear();
+    if (header.no_of_solutions % header.keyframe_interval == 0) {
+        keyframe_offsets.push_back(file_size);
+        record.push_back(SOLUTION_RECORD_FULL);
+        record.insert(record.end(), current.begin(), current.end());
+    }
+    else {
+        // previous keeps xor with current, it becomes current after write
+        std::uint64_t no_of_changed = 0;
+        for (std::size_t i = 0; i < current.size(); ++i) {
+            previous[i] ^= current[i];
+            no_of_changed += __builtin_popcount(previous[i]);
+        }
+        record.push_back(SOLUTION_RECORD_XOR_LIST);
+        appendVarint(&record, no_of_changed);
+        std::uint64_t last_id = 0;
+        for (std::size_t i = 0; i < previous.size() && record.size() <= previous.size(); ++i) {
+            for (std::uint8_t bits = previous[i]; bits != 0; bits &= bits - 1) {
+                std::uint64_t id = 8 * i + __builtin_ctz(bits);
+                appendVarint(&record, id - last_id);
+                last_id = id;
+            }
+        }
+        if (record.size() > previous.size()) {
+            record.assign(1, SOLUTION_RECORD_XOR_BITS);
+            record.insert(record.end(), previous.begin(), previous.end());
+        }
+    }
+    if (!write(record.data(), record.size())) {
+        return false;
+    }
+    previous.swap(current);
+    header.no_of_solutions++;
+    return true;
+}
+
+std::ptrdiff_t SolutionSetWriter::getNoOfSolutions(){
+    return header.no_of_solutions;
+}
+
+bool SolutionSetWriter::close(){
+    if (file == nullptr) {
+        return false;
+    }
+    // index is 8 bytes aligned, so it can be read from mapped file
+    static const char padding[8] = {0};
+    bool result = write(padding, (8 - file_size % 8) % 8);
+    header.index_offset = file_size;
+    result = result && write(keyframe_offsets.data(), keyframe_offsets.size() * sizeof(std::uint64_t));
+    result = result && std::fseek(file, 0, SEEK_SET) == 0 &&
+             std::fwrite(&header, sizeof(header), 1, file) == 1;
+    result = std::fclose(file) == 0 && result;
+    file = nullptr;
+    return result;
+}
+
+SolutionSetReader::SolutionSetReader(std::string file_name){
+    is_open = false;
+    header = nullptr;
+    keyframe_offsets = nullptr;
+    index = -1;
+    offset = 0;
+    if (!openParserBuffer(file_name, &buffer)) {
+        return;
+    }
+    std::size_t size = buffer.end - buffer.begin;
+    header = (const solution_set_header*)buffer.begin;
+    if (size < sizeof(solution_set_header) ||
+        std::memcmp(header->magic, SOLUTION_SET_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SOLUTION_SET_VERSION ||
+        header->byte_order != BINARY_PUZZLE_BYTE_ORDER ||
+        header->keyframe_interval == 0) {
+        ERROR("Not a solution set: ", file_name);
+        closeParserBuffer(&buffer);
+        return;
+    }
+    std::uint64_t no_of_keyframes = (header->no_of_solutions + header->keyframe_interval - 1) /
+                                    header->keyframe_interval;
+    if (header->index_offset % 8 != 0 || header->index_offset < sizeof(solution_set_header) ||
+        header->index_offset > size ||
+        no_of_keyframes > (size - header->index_offset) / sizeof(std::uint64_t)) {
+        ERROR("Solution set is truncated: ", file_name);
+        closeParserBuffer(&buffer);
+        return;
+    }
+    std::size_t checked_size = header->index_offset + no_of_keyframes * sizeof(std::uint64_t) -
+                               sizeof(solution_set_header);
+    if (getChecksum(buffer.begin + sizeof(solution_set_header), checked_size) != header->checksum) {
+        ERROR("Solution set checksum mismatch: ", file_name);
+        closeParserBuffer(&buffer);
+        return;
+    }
+    keyframe_offsets = (const std::uint64_t*)(buffer.begin + header->index_offset);
+    bits.assign((header->no_of_edges + 7) / 8, 0);
+    offset = sizeof(solution_set_header);
+    is_open = true;
+}
+
+SolutionSetReader::~SolutionSetReader(){
+    if (is_open) {
+        closeParserBuffer(&buffer);
+    }
+}
+
+bool SolutionSetReader::isOpen(){
+    return is_open;
+}
+
+std::ptrdiff_t SolutionSetReader::getNoOfSolutions(){
+    return is_open ? header->no_of_solutions : 0;
+}
+
+std::ptrdiff_t SolutionSetReader::getNoOfEdges(){
+    return is_open ? header->no_of_edges : 0;
+}
+
+bool SolutionSetReader::readRecord(){
+    const std::uint8_t* current = (const std::uint8_t*)buffer.begin + offset;
+    const std::uint8_t* end = (const std::uint8_t*)buffer.begin + header->index_offset;
+    if (current >= end) {
+        return false;
+    }
+    std::uint8_t type = *current++;
+    if (type == SOLUTION_RECORD_FULL || type == SOLUTION_RECORD_XOR_BITS) {
+        if ((std::size_t)(end - current) < bits.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            bits[i] = type == SOLUTION_RECORD_FULL ? current[i] : bits[i] ^ current[i];
+        }
+        current += bits.size();
+    }
+    else if (type == SOLUTION_RECORD_XOR_LIST) {
+        std::uint64_t no_of_changed = 0;
+        std::uint64_t id = 0;
+        if (!readVarint(&current, end, &no_of_changed)) {
+            return false;
+        }
+        for (std::uint64_t i = 0; i < no_of_changed; ++i) {
+            std::uint64_t gap = 0;
+            if (!readVarint(&current, end, &gap) || (id += gap) >= header->no_of_edges) {
+                return false;
+            }
+            bits[id / 8] ^= (std::uint8_t)(1 << (id % 8));
+        }
+    }
+    else {
+        return false;
+    }
+    offset = current - (const std::uint8_t*)buffer.begin;
+    return true;
+}
+
+bool SolutionSetReader::nextSolution(){
+    if (!is_open || index + 1 >= (std::ptrdiff_t)header->no_of_solutions) {
+        return false;
+    }
+    if (!readRecord()) {
+        ERROR("Corrupted solution ", index + 1);
+        return false;
+    }
+    ++index;
+    return true;
+}
+
+bool SolutionSetReader::seekSolution(std::ptrdiff_t new_index){
+    if (!is_open || new_index < 0 || new_index >= (std::ptrdiff_t)header->no_of_solutions) {
+        return false;
+    }
+    if (new_index < index || new_index / header->keyframe_interval != index / header->keyframe_interval) {
+        std::uint64_t keyframe = new_index / header->keyframe_interval;
+        offset = keyframe_offsets[keyframe];
+        index = keyframe * header->keyframe_interval - 1;
+    }
+    while (index < new_index) {
+        if (!nextSolution()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::ptrdiff_t SolutionSetReader::getIndex(){
+    return index;
+}
+
+const std::vector<std::uint8_t>& SolutionSetReader::getBits() const {
+    return bits;
+}
+
+void SolutionSetReader::applySolution(Slitherlink* slitherlink){
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges && i < (std::ptrdiff_t)header->no_of_edges; ++i) {
+        slitherlink->edges[i]->solution = isInSolution(i) ? EDGE_IN_SOLUTION : EDGE_NOT_IN_SOLUTION;
+    }
+}
@@ -0,0 +1,25 @@
+#include "../api/topology_cache.hpp"
+#include "../../../utilities/api/trace_lib.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+typedef std::tuple<grid_type, std::ptrdiff_t, std::ptrdiff_t> topology_key;
+
+const Slitherlink* getBlankTopology(grid_type type, std::ptrdiff_t width, std::ptrdiff_t height){
+    static std::mutex mutex;
+    static std::map<topology_key, std::unique_ptr<Slitherlink>> topologies;
+    if (type == GRID_HEXAGONAL) {
+        height = 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<Slitherlink>& topology = topologies[topology_key(type, width, height)];
+    if (!topology) {
+        LOG("Building topology ", type, " ", width, " ", height);
+        topology.reset(type == GRID_HEXAGONAL ?
+                       Slitherlink::buildHexagonal(width) :
+                       Slitherlink::buildSquare(width, height));
+    }
+    return topology.get();
+}
@@ -0,0 +1,117 @@
+#include "../../model/model_CPP/api/slitherlink.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#ifndef FRONTIER_SOLVER_HPP
+#define FRONTIER_SOLVER_HPP
+
+/**
+ * Node of zero-suppressed decision diagram of all solutions.
+ * Level is position of edge in processing order, lo and hi are
+ * children for edge not in solution and in solution.
+ * Node ids 0 and 1 are terminals.
+ */
+typedef struct frontier_node {
+    std::ptrdiff_t level;
+    std::ptrdiff_t lo;
+    std::ptrdiff_t hi;
+} frontier_node;
+
+#define FRONTIER_TERMINAL_0 0
+#define FRONTIER_TERMINAL_1 1
+
+/**
+ * Frontier-based dynamic programming over edges.
+ * Edges are processed in fixed order, by default sweep by distance from
+ * peripheral vertex (order of ids, the spiral of layers for hexagonal
+ * puzzles, has about twice as wide frontier). Search state is only
+ * the frontier: for every vertex touched by processed and unprocessed
+ * edges its mate (other end of its path) and for every such face number
+ * of edges in solution. Equal frontier states are merged, so number of
+ * single loop solutions is counted without enumerating them.
+ * Counts are exact up to 2^64.
+ */
+class FrontierSolver {
+    public:
+        FrontierSolver(Slitherlink* slitherlink);
+
+        FrontierSolver(Slitherlink* slitherlink,
+                       std::vector<std::ptrdiff_t> edge_order);
+
+        /**
+         * Count solutions of puzzle, keeping only one layer of states.
+         */
+        std::uint64_t countSolutions();
+
+        /**
+         * Build reduced ZDD of all solutions, used for
+         * enumerating and sampling them.
+         */
+        void buildDiagram();
+
+        std::size_t getNoOfNodes();
+
+        std::uint64_t getNoOfDiagramSolutions();
+
+        /**
+         * Write solution of given index (0 <= index < number of solutions)
+         * into edges of puzzle of the same topology.
+         * @return false if there is no such solution
+         */
+        bool getSolution(std::uint64_t index, Slitherlink* solution);
+
+        /**
+         * Write uniformly sampled solution into edges of puzzle.
+         * @return false if puzzle has no solution
+         */
+        bool sampleSolution(std::mt19937* rng, Slitherlink* solution);
+
+        /**
+         * Largest number of vertices and faces in frontier.
+         */
+        std::size_t getMaxFrontierWidth();
+
+    private:
+        Slitherlink* slitherlink;
+        std::vector<std::ptrdiff_t> edge_order;
+
+        /**
+         * Frontier before processing every edge in order
+         * and elements entering it with that edge
+         */
+        std::vector<std::vector<std::ptrdiff_t>> frontier_vertices;
+        std::vector<std::vector<std::ptrdiff_t>> frontier_faces;
+        std::vector<std::vector<std::ptrdiff_t>> entering_vertices;
+        std::vector<std::vector<std::ptrdiff_t>> entering_faces;
+        std::vector<std::ptrdiff_t> vertex_last;
+        std::vector<std::ptrdiff_t> face_last;
+        std::vector<bool> clues_after_empty;
+
+        /**
+         * Decoded state of frontier
+         */
+        std::vector<std::int32_t> mate;
+        std::vector<std::int32_t> face_count;
+
+        std::vector<frontier_node> nodes;
+        std::vector<std::uint64_t> node_solutions;
+        std::ptrdiff_t root = FRONTIER_TERMINAL_0;
+
+        void computeSweepOrder();
+
+        void prepareFrontiers();
+
+        void decodeState(std::ptrdiff_t level, const std::vector<std::int32_t>& state);
+
+        int processEdge(std::ptrdiff_t level,
+                        bool in_solution,
+                        std::vector<std::int32_t>* new_state);
+
+        std::uint64_t run(bool build_diagram);
+
+        void reduceDiagram();
+};
+
+#endif // FRONTIER_SOLVER_HPP
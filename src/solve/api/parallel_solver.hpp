@@ -0,0 +1,32 @@
+#include "../../model/model_CPP/api/slitherlink.hpp"
+
+#include <cstddef>
+
+#ifndef PARALLEL_SOLVER_HPP
+#define PARALLEL_SOLVER_HPP
+
+/**
+ * Search tree is split into at least this many branches per thread,
+ * so threads whose branches are small take other ones.
+ */
+#define PARALLEL_SOLVER_BRANCHES_PER_THREAD (4)
+
+/**
+ * Count solutions of puzzle on given number of threads, 0 uses all cores,
+ * stopping after limit is reached. Root is propagated once, then guessed
+ * edges split it into branches with those edges fixed as assumptions,
+ * so every solution is in exactly one branch. Workers take branches
+ * from shared counter and all of them stop through shared flag
+ * as soon as limit solutions are found together.
+ * Known edges of puzzle are kept as assumptions, as in Solver::startSolving.
+ */
+std::ptrdiff_t countSolutionsParallel(Slitherlink* slitherlink,
+                                      std::ptrdiff_t limit,
+                                      std::ptrdiff_t threads = 0);
+
+/**
+ * Answer ends with the second solution found by any thread.
+ */
+bool isUniqueParallel(Slitherlink* slitherlink, std::ptrdiff_t threads = 0);
+
+#endif // PARALLEL_SOLVER_HPP
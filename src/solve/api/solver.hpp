@@ -1,4 +1,9 @@
 #include "../../model/model_CPP/api/slitherlink.hpp"
+#include "../../model/model_CPP/api/topology_view.hpp"
+#include "transposition_table.hpp"
+
+#include <atomic>
+#include <iterator>
 
 
 #ifndef SOLVER_HPP
@@ -6,11 +11,12 @@
 
 typedef enum euque_item_type {
     QUEUE_ITEM_FACE,
-    QUEUE_ITEM_VERTEX
+    QUEUE_ITEM_VERTEX,
+    QUEUE_ITEM_NONE
 } queue_item_type;
 
 typedef struct solver_state {
-    Slitherlink* slitherlink;
+    std::vector<slitherlink_edge_type> edge_solutions;
     std::ptrdiff_t edge_id;
     slitherlink_edge_type edge_solution;
     std::vector<bool> faces_solved;
@@ -18,8 +24,22 @@ typedef struct solver_state {
     std::vector<std::ptrdiff_t> edge_to_loop_part;
     std::ptrdiff_t max_loop_part_id = -1;
     std::ptrdiff_t no_of_loop_parts = 0;
+    std::vector<std::pair<queue_item_type, std::ptrdiff_t>> edge_cause;
+    std::vector<std::ptrdiff_t> edge_order;
+    std::ptrdiff_t next_edge_order = 0;
 } solver_state;
 
+/**
+ * Guess whose subtree is still being searched.
+ * Once both values of guessed edge are explored, number of
+ * solutions found below it is stored in transposition table.
+ */
+typedef struct search_node {
+    std::uint64_t hash;
+    std::ptrdiff_t depth;
+    std::ptrdiff_t no_of_solutions;
+} search_node;
+
 typedef struct rule_state {
     std::ptrdiff_t no_of_vertices;
     std::ptrdiff_t no_of_edges;
@@ -31,20 +51,223 @@ typedef struct rule_state {
 
 class Solver {
     public:
+        /**
+         * Input iterator over solutions found by the solver.
+         * Dereferencing gives puzzle owned by the solver,
+         * which is valid only until the iterator is incremented.
+         */
+        class SolutionIterator {
+            public:
+                typedef std::input_iterator_tag iterator_category;
+                typedef Slitherlink value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef Slitherlink* pointer;
+                typedef Slitherlink& reference;
+
+                SolutionIterator(Solver* solver, Slitherlink* solution);
+
+                reference operator*() const;
+                pointer operator->() const;
+                SolutionIterator& operator++();
+                bool operator==(const SolutionIterator& other) const;
+                bool operator!=(const SolutionIterator& other) const;
+            private:
+                Solver* solver;
+                Slitherlink* solution;
+        };
+
+        /**
+         * Range of solutions of one puzzle, searched lazily while iterating.
+         */
+        class SolutionRange {
+            public:
+                SolutionRange(Solver* solver, Slitherlink* slitherlink);
+
+                SolutionIterator begin();
+                SolutionIterator end();
+            private:
+                Solver* solver;
+                Slitherlink* slitherlink;
+        };
+
         Solver();
         ~Solver();
 
         void solvePuzzle(Slitherlink* slitherlink,
                          std::vector<Slitherlink*>* slitherlink_solution);
+
+        /**
+         * Prepare search over solutions of given puzzle.
+         * Puzzle is copied, so it can be modified after this call.
+         * Edges that are already known are kept as fixed assumptions,
+         * call clearSolution() on puzzle first to solve it from scratch.
+         */
+        void startSolving(Slitherlink* slitherlink);
+
+        /**
+         * Resume search until next solution is found.
+         * @return solved puzzle owned by the solver, valid until next call,
+         *         or nullptr if there are no more solutions
+         */
+        Slitherlink* nextSolution();
+
+        /**
+         * Lazily iterate over solutions of given puzzle, e.g.
+         * for (Slitherlink& solution : solver.solutions(puzzle)) { ... }
+         */
+        SolutionRange solutions(Slitherlink* slitherlink);
+
+        /**
+         * Incremental clue editing.
+         * startEditing() propagates given puzzle without guessing and keeps
+         * that state alive. setClue() and clearClue() retract only the
+         * deductions that depended on edited face and propagate again
+         * from the affected faces and vertices.
+         * @return false if puzzle with edited clue has no solution
+         */
+        bool startEditing(Slitherlink* slitherlink);
+
+        bool setClue(std::ptrdiff_t face_id, std::ptrdiff_t value);
+
+        bool clearClue(std::ptrdiff_t face_id);
+
+        /**
+         * Count solutions of edited puzzle, stopping after limit is reached.
+         * State of edited puzzle is kept for further edits.
+         */
+        std::ptrdiff_t countSolutions(std::ptrdiff_t limit);
+
+        bool isUnique();
+
+        /**
+         * Copy of edited puzzle with edges known after propagation,
+         * nullptr if it has no solution. Caller owns the copy.
+         */
+        Slitherlink* copyPropagated();
+
+        /**
+         * Search ends as if no more solutions were found once flag is set,
+         * so many solvers can be stopped together. nullptr disables it.
+         * Flag is not owned by the solver.
+         */
+        void setStopFlag(const std::atomic<bool>* flag);
+
+        /**
+         * Use table to skip search nodes that were already explored,
+         * nullptr disables it. Table is not owned by the solver
+         * and can be shared between solvers of puzzles on the same grid.
+         */
+        void setTranspositionTable(TranspositionTable* table);
+
+        /**
+         * Hash of subproblem left in current state: undecided edges,
+         * clues left for their faces and pairing of loop ends.
+         */
+        std::uint64_t getNodeKey();
     private:
 
         Slitherlink* original_slitherlink;
         Slitherlink* slitherlink;
 
-        bool updateFaceEdges(std::ptrdiff_t face_id);
-        
-        bool updateVertexEdges(std::ptrdiff_t vertex_id);
+        /**
+         * Search stopped at a solution, so next search has to
+         * start by restoring the last guess
+         */
+        bool solution_pending = false;
+        bool search_finished = false;
+
+        void clearSearchState();
+
+        /**
+         * Drop saved guesses, puzzle keeps its current edges
+         */
+        void clearGuesses();
+
+        /**
+         * Reset every edge except assumptions and queue
+         * assumptions and clues for propagation.
+         */
+        bool seedPropagation();
+
+        bool propagate();
+
+        template<typename Topology>
+        bool propagate(const Topology& topology);
+
+        void saveState(solver_state* state);
+
+        void loadState(solver_state* state);
+
+        void fillUnknownEdges();
+
+        /**
+         * Rules are templated on topology view, puzzle on hexagonal grid
+         * of size from FIXED_HEX_MIN_SIZE to FIXED_HEX_MAX_SIZE reads
+         * edges of element from constexpr tables, other puzzles from
+         * their id lists.
+         */
+        std::ptrdiff_t fixed_hex_size = 0;
+
+        /**
+         * State of every edge, the same as solution of puzzle edges,
+         * kept flat so that rules don't go through edge pointers.
+         */
+        std::vector<slitherlink_edge_type> edge_solutions;
+
+        void setEdgeSolution(slitherlink_edge* edge_p, slitherlink_edge_type solution);
+
+        template<typename Topology>
+        bool updateFaceEdges(const Topology& topology, std::ptrdiff_t face_id);
+
+        template<typename Topology>
+        bool updateVertexEdges(const Topology& topology, std::ptrdiff_t vertex_id);
+
+
+        /**
+         * Why every edge got its value: face or vertex that deduced it
+         * (QUEUE_ITEM_NONE for assumptions and guesses) and order
+         * of assignment. Used to retract deductions after clue edit.
+         */
+        std::vector<bool> edge_is_assumption;
+        std::vector<std::pair<queue_item_type, std::ptrdiff_t>> edge_cause;
+        std::vector<std::ptrdiff_t> edge_order;
+        std::ptrdiff_t next_edge_order = 0;
+        bool root_consistent = false;
 
+        /**
+         * Key is computed only at guess nodes, when table is set
+         */
+        TranspositionTable* transposition_table = nullptr;
+        const std::atomic<bool>* stop_flag = nullptr;
+        std::uint64_t node_key = 0;
+        std::vector<search_node> search_nodes;
+
+        /**
+         * Solutions found so far, including those skipped thanks
+         * to transposition table when only counting them
+         */
+        std::ptrdiff_t no_of_solutions = 0;
+        std::ptrdiff_t solution_limit = -1;
+        bool skip_known_solutions = false;
+
+        bool isKnownNode();
+
+        void finishSearchNodes();
+
+        void assignEdge(slitherlink_edge* edge_p,
+                        slitherlink_edge_type solution,
+                        std::pair<queue_item_type, std::ptrdiff_t> cause);
+
+        void retractDeductions(std::ptrdiff_t face_id);
+
+        void retractCausedBy(const std::vector<slitherlink_edge*>& edge_refs,
+                             std::pair<queue_item_type, std::ptrdiff_t> cause,
+                             std::ptrdiff_t order,
+                             std::vector<slitherlink_edge*>* retracted);
+
+        bool rebuildLoops();
+
+        bool editClue(std::ptrdiff_t face_id, std::ptrdiff_t value);
 
         /**
          * Check what parts of puzzle are solved
@@ -67,6 +290,34 @@ class Solver {
 
         bool addToLoops(std::ptrdiff_t edge_id);
 
+        void setLoopPart(std::ptrdiff_t edge_id, std::ptrdiff_t part_id);
+
+        /**
+         * Returns id of other edge in solution adjacent to vertex,
+         * -1 if there is none and -2 if there is more than one.
+         */
+        std::ptrdiff_t getLoopNeighbour(slitherlink_vertex* vertex_p,
+                                        std::ptrdiff_t edge_id);
+
+        /**
+         * Failed edge probing: value of edge that leads to contradiction
+         * after propagation is ruled out. Probes are undone from trail
+         * of changed edges, so only their neighbourhood is touched.
+         * Edge whose probes assigned the most other edges is guessed next.
+         * @return false if both values of some edge fail
+         */
+        bool probeEdges();
+
+        /**
+         * @return false if assigning edge leads to contradiction
+         */
+        bool probeEdge(slitherlink_edge* edge_p, slitherlink_edge_type solution);
+
+        std::ptrdiff_t probe_guess_edge_id = -1;
+        bool is_probing = false;
+        std::vector<std::ptrdiff_t> probe_edge_ids;
+        std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> probe_loop_parts;
+
         /**
          * Queue for BFS solution finding
          * Each item is a pointer to a slitherlink object 
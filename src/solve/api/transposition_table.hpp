@@ -0,0 +1,70 @@
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#ifndef TRANSPOSITION_TABLE_HPP
+#define TRANSPOSITION_TABLE_HPP
+
+/**
+ * Random 64 bit key for Zobrist hashing of puzzle state.
+ * Keys are computed from index instead of being stored,
+ * so every solver (and thread) uses the same keys.
+ */
+inline std::uint64_t zobristKey(std::uint64_t index) {
+    // splitmix64
+    std::uint64_t z = index + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Bounded, lock-free table of search nodes with known number of solutions.
+ * Every entry keeps hash xor value next to value, so torn writes from
+ * concurrent threads are detected on probe and treated as miss.
+ * Table can be shared by many solvers of puzzles on the same grid.
+ */
+class TranspositionTable {
+    public:
+        /**
+         * @param no_of_entries capacity of table, rounded up to power of 2
+         */
+        TranspositionTable(std::size_t no_of_entries);
+
+        /**
+         * @return true and number of solutions of node if it is in table
+         */
+        bool probe(std::uint64_t hash, std::ptrdiff_t* no_of_solutions);
+
+        /**
+         * Record node with fully explored subtree, replacing older entry.
+         */
+        void store(std::uint64_t hash, std::ptrdiff_t no_of_solutions);
+
+        void clear();
+
+        std::size_t getNoOfEntries() const;
+        std::uint64_t getNoOfProbes() const;
+        std::uint64_t getNoOfHits() const;
+        std::uint64_t getNoOfStores() const;
+        std::uint64_t getNoOfOverwrites() const;
+        double getHitRate() const;
+
+    private:
+        typedef struct table_entry {
+            std::atomic<std::uint64_t> check;
+            std::atomic<std::uint64_t> value;
+        } table_entry;
+
+        std::size_t no_of_entries;
+        std::size_t mask;
+        std::unique_ptr<table_entry[]> entries;
+
+        std::atomic<std::uint64_t> no_of_probes;
+        std::atomic<std::uint64_t> no_of_hits;
+        std::atomic<std::uint64_t> no_of_stores;
+        std::atomic<std::uint64_t> no_of_overwrites;
+};
+
+#endif // TRANSPOSITION_TABLE_HPP
@@ -0,0 +1,53 @@
+#include "../../model/model_CPP/api/slitherlink.hpp"
+#include "../../model/model_CPP/api/topology_view.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#ifndef VERIFIER_HPP
+#define VERIFIER_HPP
+
+/**
+ * Result of solution verification, first error found is reported.
+ */
+typedef enum verification_result {
+    VERIFICATION_CORRECT,
+    VERIFICATION_UNKNOWN_EDGE,
+    VERIFICATION_WRONG_CLUE,
+    VERIFICATION_WRONG_DEGREE,
+    VERIFICATION_NO_LOOP,
+    VERIFICATION_MANY_LOOPS
+} verification_result;
+
+const char* getVerificationName(verification_result result);
+
+/**
+ * Check that edges of puzzle are correct solution: every clue is met,
+ * every vertex has 0 or 2 edges in solution and they form single loop.
+ * Works in one pass over edges and one traversal of the loop.
+ */
+verification_result verifySolution(Slitherlink* slitherlink);
+
+/**
+ * Same as verifySolution for solution given as bits of edges
+ * (e.g. from SolutionSetReader), edges of puzzle are not used.
+ */
+verification_result verifySolution(Slitherlink* slitherlink, const std::vector<std::uint8_t>& bits);
+
+/**
+ * Same check on implicit hexagonal grid, no puzzle is built. Clues are
+ * given per face (FACE_NO_VALUE for no clue), solution as bits of edges.
+ * Sizes from FIXED_HEX_MIN_SIZE to FIXED_HEX_MAX_SIZE use compile-time topology.
+ */
+verification_result verifySolution(const HexTopology& topology,
+                                   const std::vector<std::int8_t>& clues,
+                                   const std::vector<std::uint8_t>& bits);
+
+/**
+ * Verify many solutions on all cores.
+ * @return number of correct solutions
+ */
+std::ptrdiff_t verifySolutions(const std::vector<Slitherlink*>& solutions,
+                               std::vector<verification_result>* results);
+
+#endif // VERIFIER_HPP
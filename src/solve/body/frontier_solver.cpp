@@ -0,0 +1,463 @@
+#include "../api/frontier_solver.hpp"
+#include "../../utilities/api/trace_lib.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+#define EDGE_RESULT_PRUNED 0
+#define EDGE_RESULT_CLOSED 1
+#define EDGE_RESULT_CONTINUE 2
+
+// Mate of vertex with two edges in solution,
+// vertex without any has itself as mate
+#define MATE_INNER -2
+
+typedef struct frontier_state_hash {
+    std::size_t operator()(const std::vector<std::int32_t>& state) const {
+        std::size_t hash = state.size();
+        for (std::int32_t value : state) {
+            hash ^= (std::size_t)value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+} frontier_state_hash;
+
+typedef std::unordered_map<std::vector<std::int32_t>, std::ptrdiff_t, frontier_state_hash> frontier_layer;
+
+FrontierSolver::FrontierSolver(Slitherlink* slitherlink) {
+    this->slitherlink = slitherlink;
+    computeSweepOrder();
+    prepareFrontiers();
+}
+
+FrontierSolver::FrontierSolver(Slitherlink* slitherlink,
+                               std::vector<std::ptrdiff_t> edge_order) {
+    this->slitherlink = slitherlink;
+    this->edge_order = edge_order;
+    assert((std::ptrdiff_t)edge_order.size() == slitherlink->no_of_edges);
+    prepareFrontiers();
+}
+
+static std::vector<std::ptrdiff_t> getVertexDistances(Slitherlink* slitherlink,
+                                                      std::ptrdiff_t start_id) {
+    std::vector<std::ptrdiff_t> distance(slitherlink->no_of_vertices, -1);
+    std::vector<std::ptrdiff_t> bfs_queue;
+    bfs_queue.reserve(slitherlink->no_of_vertices);
+    bfs_queue.push_back(start_id);
+    distance[start_id] = 0;
+    for (std::size_t i = 0; i < bfs_queue.size(); ++i) {
+        std::ptrdiff_t vertex_id = bfs_queue[i];
+        for (slitherlink_edge* edge_p : slitherlink->vertices[vertex_id]->edge_refs) {
+            std::ptrdiff_t next_id = edge_p->vertices[0] == vertex_id ?
+                                     edge_p->vertices[1] :
+                                     edge_p->vertices[0];
+            if (distance[next_id] == -1) {
+                distance[next_id] = distance[vertex_id] + 1;
+                bfs_queue.push_back(next_id);
+            }
+        }
+    }
+    return distance;
+}
+
+void FrontierSolver::computeSweepOrder() {
+    // Sweep from peripheral vertex - its frontier is narrower
+    // than the one of spiral given by edge ids
+    edge_order.clear();
+    if (slitherlink->no_of_vertices == 0) {
+        return;
+    }
+    std::vector<std::ptrdiff_t> distance = getVertexDistances(slitherlink, 0);
+    std::ptrdiff_t start_id = std::max_element(distance.begin(), distance.end()) - distance.begin();
+    distance = getVertexDistances(slitherlink, start_id);
+
+    std::vector<std::pair<std::pair<std::ptrdiff_t, std::ptrdiff_t>, std::ptrdiff_t>> keys;
+    for (slitherlink_edge* edge_p : slitherlink->edges) {
+        std::ptrdiff_t distance_0 = distance[edge_p->vertices[0]];
+        std::ptrdiff_t distance_1 = distance[edge_p->vertices[1]];
+        keys.push_back(std::make_pair(std::make_pair(std::max(distance_0, distance_1),
+                                                     std::min(distance_0, distance_1)),
+                                      edge_p->id));
+    }
+    std::sort(keys.begin(), keys.end());
+    for (const auto& key : keys) {
+        edge_order.push_back(key.second);
+    }
+}
+
+void FrontierSolver::prepareFrontiers() {
+    std::ptrdiff_t no_of_levels = edge_order.size();
+    std::ptrdiff_t no_of_faces = slitherlink->no_of_faces - 1; // without outer face
+    std::vector<std::ptrdiff_t> vertex_first(slitherlink->no_of_vertices, -1);
+    std::vector<std::ptrdiff_t> face_first(no_of_faces, -1);
+    vertex_last.assign(slitherlink->no_of_vertices, -1);
+    face_last.assign(no_of_faces, -1);
+    entering_vertices.assign(no_of_levels, std::vector<std::ptrdiff_t>());
+    entering_faces.assign(no_of_levels, std::vector<std::ptrdiff_t>());
+
+    for (std::ptrdiff_t level = 0; level < no_of_levels; ++level) {
+        slitherlink_edge* edge_p = slitherlink->edges[edge_order[level]];
+        for (std::ptrdiff_t j = 0; j < 2; ++j) {
+            std::ptrdiff_t vertex_id = edge_p->vertices[j];
+            if (vertex_first[vertex_id] == -1) {
+                vertex_first[vertex_id] = level;
+                entering_vertices[level].push_back(vertex_id);
+            }
+            vertex_last[vertex_id] = level;
+            std::ptrdiff_t face_id = edge_p->face_ids[j];
+            if (face_id == OUTER_FACE) {
+                continue;
+            }
+            if (face_first[face_id] == -1) {
+                face_first[face_id] = level;
+                entering_faces[level].push_back(face_id);
+            }
+            face_last[face_id] = level;
+        }
+    }
+
+    // faces not reached yet have no edge in solution
+    std::ptrdiff_t last_nonzero_face_first = -1;
+    for (std::ptrdiff_t i = 0; i < no_of_faces; ++i) {
+        std::ptrdiff_t value = slitherlink->faces[i]->value;
+        if (value != FACE_NO_VALUE && value != 0) {
+            last_nonzero_face_first = std::max(last_nonzero_face_first, face_first[i]);
+        }
+    }
+    clues_after_empty.assign(no_of_levels + 1, true);
+    for (std::ptrdiff_t level = 0; level <= last_nonzero_face_first; ++level) {
+        clues_after_empty[level] = false;
+    }
+
+    frontier_vertices.assign(no_of_levels + 1, std::vector<std::ptrdiff_t>());
+    frontier_faces.assign(no_of_levels + 1, std::vector<std::ptrdiff_t>());
+    for (std::ptrdiff_t level = 0; level < no_of_levels; ++level) {
+        for (std::ptrdiff_t vertex_id : frontier_vertices[level]) {
+            if (vertex_last[vertex_id] != level) {
+                frontier_vertices[level + 1].push_back(vertex_id);
+            }
+        }
+        for (std::ptrdiff_t vertex_id : entering_vertices[level]) {
+            if (vertex_last[vertex_id] != level) {
+                frontier_vertices[level + 1].push_back(vertex_id);
+            }
+        }
+        for (std::ptrdiff_t face_id : frontier_faces[level]) {
+            if (face_last[face_id] != level) {
+                frontier_faces[level + 1].push_back(face_id);
+            }
+        }
+        for (std::ptrdiff_t face_id : entering_faces[level]) {
+            if (face_last[face_id] != level) {
+                frontier_faces[level + 1].push_back(face_id);
+            }
+        }
+    }
+
+    mate.assign(slitherlink->no_of_vertices, 0);
+    face_count.assign(no_of_faces, 0);
+}
+
+std::size_t FrontierSolver::getMaxFrontierWidth() {
+    std::size_t width = 0;
+    for (std::size_t level = 0; level < frontier_vertices.size(); ++level) {
+        width = std::max(width, frontier_vertices[level].size() + frontier_faces[level].size());
+    }
+    return width;
+}
+
+void FrontierSolver::decodeState(std::ptrdiff_t level, const std::vector<std::int32_t>& state) {
+    std::size_t i = 0;
+    for (std::ptrdiff_t vertex_id : frontier_vertices[level]) {
+        mate[vertex_id] = state[i++];
+    }
+    for (std::ptrdiff_t face_id : frontier_faces[level]) {
+        face_count[face_id] = state[i++];
+    }
+    for (std::ptrdiff_t vertex_id : entering_vertices[level]) {
+        mate[vertex_id] = vertex_id;
+    }
+    for (std::ptrdiff_t face_id : entering_faces[level]) {
+        face_count[face_id] = 0;
+    }
+}
+
+static inline std::ptrdiff_t getDegree(std::int32_t mate, std::ptrdiff_t vertex_id) {
+    if (mate == vertex_id) {
+        return 0;
+    }
+    return mate == MATE_INNER ? 2 : 1;
+}
+
+static inline bool isClueMet(std::ptrdiff_t value, std::int32_t count) {
+    return value == FACE_NO_VALUE || value == count;
+}
+
+int FrontierSolver::processEdge(std::ptrdiff_t level,
+                                bool in_solution,
+                                std::vector<std::int32_t>* new_state) {
+    slitherlink_edge* edge_p = slitherlink->edges[edge_order[level]];
+    std::ptrdiff_t u = edge_p->vertices[0];
+    std::ptrdiff_t v = edge_p->vertices[1];
+
+    if (in_solution) {
+        std::ptrdiff_t degree_u = getDegree(mate[u], u);
+        std::ptrdiff_t degree_v = getDegree(mate[v], v);
+        if (degree_u == 2 || degree_v == 2) {
+            return EDGE_RESULT_PRUNED;
+        }
+        for (std::ptrdiff_t j = 0; j < 2; ++j) {
+            std::ptrdiff_t face_id = edge_p->face_ids[j];
+            if (face_id == OUTER_FACE) {
+                continue;
+            }
+            face_count[face_id]++;
+            std::ptrdiff_t value = slitherlink->faces[face_id]->value;
+            if (value != FACE_NO_VALUE && face_count[face_id] > value) {
+                return EDGE_RESULT_PRUNED;
+            }
+        }
+
+        if (mate[u] == v) {
+            // loop is closed, so all other edges are not in solution
+            if (!clues_after_empty[level + 1]) {
+                return EDGE_RESULT_PRUNED;
+            }
+            for (std::ptrdiff_t vertex_id : frontier_vertices[level]) {
+                if (vertex_id != u && vertex_id != v &&
+                    getDegree(mate[vertex_id], vertex_id) == 1) {
+                    return EDGE_RESULT_PRUNED;
+                }
+            }
+            for (std::ptrdiff_t face_id : frontier_faces[level]) {
+                if (!isClueMet(slitherlink->faces[face_id]->value, face_count[face_id])) {
+                    return EDGE_RESULT_PRUNED;
+                }
+            }
+            for (std::ptrdiff_t face_id : entering_faces[level]) {
+                if (!isClueMet(slitherlink->faces[face_id]->value, face_count[face_id])) {
+                    return EDGE_RESULT_PRUNED;
+                }
+            }
+            return EDGE_RESULT_CLOSED;
+        }
+
+        std::int32_t end_u = degree_u == 0 ? u : mate[u];
+        std::int32_t end_v = degree_v == 0 ? v : mate[v];
+        mate[end_u] = end_v;
+        mate[end_v] = end_u;
+        if (degree_u == 1) {
+            mate[u] = MATE_INNER;
+        }
+        if (degree_v == 1) {
+            mate[v] = MATE_INNER;
+        }
+    }
+
+    // elements leaving frontier have to be finished
+    for (std::ptrdiff_t j = 0; j < 2; ++j) {
+        std::ptrdiff_t vertex_id = edge_p->vertices[j];
+        if (vertex_last[vertex_id] == level &&
+            getDegree(mate[vertex_id], vertex_id) == 1) {
+            return EDGE_RESULT_PRUNED;
+        }
+        std::ptrdiff_t face_id = edge_p->face_ids[j];
+        if (face_id != OUTER_FACE &&
+            face_last[face_id] == level &&
+            !isClueMet(slitherlink->faces[face_id]->value, face_count[face_id])) {
+            return EDGE_RESULT_PRUNED;
+        }
+    }
+
+    new_state->clear();
+    for (std::ptrdiff_t vertex_id : frontier_vertices[level + 1]) {
+        new_state->push_back(mate[vertex_id]);
+    }
+    for (std::ptrdiff_t face_id : frontier_faces[level + 1]) {
+        new_state->push_back(face_count[face_id]);
+    }
+    return EDGE_RESULT_CONTINUE;
+}
+
+std::uint64_t FrontierSolver::run(bool build_diagram) {
+    std::ptrdiff_t no_of_levels = edge_order.size();
+    std::uint64_t no_of_solutions = 0;
+
+    if (build_diagram) {
+        nodes.clear();
+        nodes.push_back(frontier_node{.level = no_of_levels, .lo = 0, .hi = 0});
+        nodes.push_back(frontier_node{.level = no_of_levels, .lo = 1, .hi = 1});
+    }
+
+    // states of current layer with number of ways to reach them (or node id)
+    frontier_layer layer;
+    std::vector<std::uint64_t> layer_counts;
+    std::vector<std::ptrdiff_t> layer_nodes;
+    layer[std::vector<std::int32_t>()] = 0;
+    layer_counts.push_back(1);
+    if (build_diagram) {
+        layer_nodes.push_back(nodes.size());
+        nodes.push_back(frontier_node{.level = 0, .lo = 0, .hi = 0});
+    }
+
+    std::vector<std::int32_t> new_state;
+    for (std::ptrdiff_t level = 0; level < no_of_levels; ++level) {
+        frontier_layer next_layer;
+        std::vector<std::uint64_t> next_counts;
+        std::vector<std::ptrdiff_t> next_nodes;
+        for (const auto& item : layer) {
+            std::uint64_t count = layer_counts[item.second];
+            for (int in_solution = 0; in_solution < 2; ++in_solution) {
+                decodeState(level, item.first);
+                int result = processEdge(level, in_solution, &new_state);
+                std::ptrdiff_t child = FRONTIER_TERMINAL_0;
+                if (result == EDGE_RESULT_CLOSED) {
+                    no_of_solutions += count;
+                    child = FRONTIER_TERMINAL_1;
+                }
+                else if (result == EDGE_RESULT_CONTINUE) {
+                    auto found = next_layer.find(new_state);
+                    std::ptrdiff_t index = 0;
+                    if (found == next_layer.end()) {
+                        index = next_counts.size();
+                        next_layer.emplace(new_state, index);
+                        next_counts.push_back(0);
+                        if (build_diagram) {
+                            next_nodes.push_back(nodes.size());
+                            nodes.push_back(frontier_node{.level = level + 1, .lo = 0, .hi = 0});
+                        }
+                    }
+                    else {
+                        index = found->second;
+                    }
+                    next_counts[index] += count;
+                    if (build_diagram) {
+                        child = next_nodes[index];
+                    }
+                }
+                if (build_diagram) {
+                    frontier_node& node = nodes[layer_nodes[item.second]];
+                    if (in_solution) {
+                        node.hi = child;
+                    }
+                    else {
+                        node.lo = child;
+                    }
+                }
+            }
+        }
+        LOG_DEBUG("Frontier level ", level, " states: ", next_layer.size());
+        layer.swap(next_layer);
+        layer_counts.swap(next_counts);
+        layer_nodes.swap(next_nodes);
+    }
+    // states left after last edge never closed a loop - their nodes stay 0-terminal
+
+    if (build_diagram) {
+        root = 2;
+        reduceDiagram();
+    }
+    return no_of_solutions;
+}
+
+std::uint64_t FrontierSolver::countSolutions() {
+    return run(false);
+}
+
+void FrontierSolver::buildDiagram() {
+    run(true);
+}
+
+// Temporary id -1 is the deepest node, it gets the biggest final id
+static inline std::ptrdiff_t renumberNode(std::ptrdiff_t no_of_reduced, std::ptrdiff_t id) {
+    return id < 0 ? no_of_reduced + 2 + id : id;
+}
+
+void FrontierSolver::reduceDiagram() {
+    // children have bigger ids than parents, so go from the bottom
+    std::vector<std::ptrdiff_t> forward(nodes.size());
+    forward[FRONTIER_TERMINAL_0] = FRONTIER_TERMINAL_0;
+    forward[FRONTIER_TERMINAL_1] = FRONTIER_TERMINAL_1;
+    std::unordered_map<std::vector<std::int32_t>, std::ptrdiff_t, frontier_state_hash> unique_nodes;
+    std::vector<frontier_node> reduced;
+    for (std::ptrdiff_t i = nodes.size() - 1; i > FRONTIER_TERMINAL_1; --i) {
+        std::ptrdiff_t lo = forward[nodes[i].lo];
+        std::ptrdiff_t hi = forward[nodes[i].hi];
+        if (hi == FRONTIER_TERMINAL_0) {
+            forward[i] = lo;
+            continue;
+        }
+        std::vector<std::int32_t> key = {(std::int32_t)nodes[i].level, (std::int32_t)lo, (std::int32_t)hi};
+        auto found = unique_nodes.find(key);
+        if (found != unique_nodes.end()) {
+            forward[i] = found->second;
+            continue;
+        }
+        // temporary negative ids, renumbered below so that root is first
+        std::ptrdiff_t id = -(std::ptrdiff_t)reduced.size() - 1;
+        reduced.push_back(frontier_node{.level = nodes[i].level, .lo = lo, .hi = hi});
+        unique_nodes.emplace(key, id);
+        forward[i] = id;
+    }
+    std::ptrdiff_t no_of_reduced = reduced.size();
+    nodes.assign(no_of_reduced + 2, frontier_node{.level = (std::ptrdiff_t)edge_order.size(), .lo = 0, .hi = 0});
+    nodes[FRONTIER_TERMINAL_1].lo = FRONTIER_TERMINAL_1;
+    nodes[FRONTIER_TERMINAL_1].hi = FRONTIER_TERMINAL_1;
+    for (std::ptrdiff_t i = 0; i < no_of_reduced; ++i) {
+        std::ptrdiff_t id = renumberNode(no_of_reduced, -i - 1);
+        nodes[id] = frontier_node{.level = reduced[i].level,
+                                  .lo = renumberNode(no_of_reduced, reduced[i].lo),
+                                  .hi = renumberNode(no_of_reduced, reduced[i].hi)};
+    }
+    root = renumberNode(no_of_reduced, forward[root]);
+
+    // number of solutions below every node, children have bigger ids
+    node_solutions.assign(nodes.size(), 0);
+    node_solutions[FRONTIER_TERMINAL_1] = 1;
+    for (std::ptrdiff_t i = nodes.size() - 1; i > FRONTIER_TERMINAL_1; --i) {
+        node_solutions[i] = node_solutions[nodes[i].lo] + node_solutions[nodes[i].hi];
+    }
+}
+
+std::size_t FrontierSolver::getNoOfNodes() {
+    return nodes.size();
+}
+
+std::uint64_t FrontierSolver::getNoOfDiagramSolutions() {
+    if (nodes.empty()) {
+        return 0;
+    }
+    return node_solutions[root];
+}
+
+bool FrontierSolver::getSolution(std::uint64_t index, Slitherlink* solution) {
+    if (index >= getNoOfDiagramSolutions()) {
+        return false;
+    }
+    for (slitherlink_edge* edge_p : solution->edges) {
+        edge_p->solution = EDGE_NOT_IN_SOLUTION;
+    }
+    std::ptrdiff_t node = root;
+    while (node != FRONTIER_TERMINAL_1) {
+        std::uint64_t lo_solutions = node_solutions[nodes[node].lo];
+        if (index < lo_solutions) {
+            node = nodes[node].lo;
+        }
+        else {
+            index -= lo_solutions;
+            solution->edges[edge_order[nodes[node].level]]->solution = EDGE_IN_SOLUTION;
+            node = nodes[node].hi;
+        }
+    }
+    return true;
+}
+
+bool FrontierSolver::sampleSolution(std::mt19937* rng, Slitherlink* solution) {
+    std::uint64_t no_of_solutions = getNoOfDiagramSolutions();
+    if (no_of_solutions == 0) {
+        return false;
+    }
+    std::uniform_int_distribution<std::uint64_t> uni(0, no_of_solutions - 1);
+    return getSolution(uni(*rng), solution);
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "../../utilities/api/trace_lib.hpp"
+#include "../api/parallel_solver.hpp"
+#include "../api/solver.hpp"
+
+/**
+ * State shared by workers counting solutions of one puzzle.
+ */
+typedef struct parallel_search {
+    const std::vector<Slitherlink*>* branches;
+    std::ptrdiff_t limit;
+    std::atomic<std::ptrdiff_t> next_branch;
+    std::atomic<std::ptrdiff_t> no_of_solutions;
+    std::atomic<bool> is_stopped;
+} parallel_search;
+
+/**
+ * Unknown edge continuing the loop from its end, as guessed by the solver,
+ * otherwise first unknown edge.
+ * @return -1 if every edge is known
+ */
+static std::ptrdiff_t getSplitEdge(const Slitherlink* slitherlink){
+    std::ptrdiff_t split_edge_id = -1;
+    for (const slitherlink_edge* edge : slitherlink->edges) {
+        if (edge->solution != EDGE_UNKNOWN) {
+            continue;
+        }
+        if (split_edge_id == -1) {
+            split_edge_id = edge->id;
+        }
+        for (const slitherlink_vertex* vertex : edge->vertex_refs) {
+            std::ptrdiff_t edges_in_solution = 0;
+            for (const slitherlink_edge* vertex_edge : vertex->edge_refs) {
+                edges_in_solution += vertex_edge->solution == EDGE_IN_SOLUTION ? 1 : 0;
+            }
+            if (edges_in_solution == 1) {
+                return edge->id;
+            }
+        }
+    }
+    return split_edge_id;
+}
+
+/**
+ * Propagated puzzle, nullptr if it has no solution.
+ */
+static Slitherlink* propagateBranch(Slitherlink* slitherlink){
+    Solver solver;
+    if (!solver.startEditing(slitherlink)) {
+        return nullptr;
+    }
+    return solver.copyPropagated();
+}
+
+/**
+ * Split breadth first until there are enough branches. Branch without
+ * unknown edges can't be split and is kept as it is.
+ */
+static void splitSearch(Slitherlink* root, std::ptrdiff_t no_of_branches, std::vector<Slitherlink*>* branches){
+    std::deque<Slitherlink*> pending;
+    pending.push_back(root);
+    while (!pending.empty() &&
+           (std::ptrdiff_t)(pending.size() + branches->size()) < no_of_branches) {
+        Slitherlink* branch = pending.front();
+        pending.pop_front();
+        std::ptrdiff_t edge_id = getSplitEdge(branch);
+        if (edge_id == -1) {
+            branches->push_back(branch);
+            continue;
+        }
+        for (slitherlink_edge_type solution : {EDGE_IN_SOLUTION, EDGE_NOT_IN_SOLUTION}) {
+            branch->edges[edge_id]->solution = solution;
+            Slitherlink* child = propagateBranch(branch);
+            if (child != nullptr) {
+                pending.push_back(child);
+            }
+        }
+        delete branch;
+    }
+    branches->insert(branches->end(), pending.begin(), pending.end());
+    LOG("Search split into branches: ", branches->size());
+}
+
+static void runWorker(parallel_search* search){
+    Solver solver;
+    solver.setStopFlag(&search->is_stopped);
+    while (!search->is_stopped) {
+        std::ptrdiff_t index = search->next_branch++;
+        if (index >= (std::ptrdiff_t)search->branches->size()) {
+            break;
+        }
+        solver.startSolving((*search->branches)[index]);
+        while (solver.nextSolution() != nullptr) {
+            if (++search->no_of_solutions >= search->limit) {
+                LOG("Solution limit reached in branch ", index);
+                search->is_stopped = true;
+            }
+        }
+    }
+}
+
+std::ptrdiff_t countSolutionsParallel(Slitherlink* slitherlink,
+                                      std::ptrdiff_t limit,
+                                      std::ptrdiff_t threads){
+    if (limit <= 0) {
+        return 0;
+    }
+    if (threads <= 0) {
+        threads = std::max<std::ptrdiff_t>(1, std::thread::hardware_concurrency());
+    }
+    Slitherlink* root = propagateBranch(slitherlink);
+    if (root == nullptr) {
+        return 0;
+    }
+    std::vector<Slitherlink*> branches;
+    if (threads == 1) {
+        branches.push_back(root);
+    }
+    else {
+        splitSearch(root, threads * PARALLEL_SOLVER_BRANCHES_PER_THREAD, &branches);
+    }
+    threads = std::min<std::ptrdiff_t>(threads, branches.size());
+
+    parallel_search search;
+    search.branches = &branches;
+    search.limit = limit;
+    search.next_branch = 0;
+    search.no_of_solutions = 0;
+    search.is_stopped = false;
+    std::vector<std::thread> workers;
+    workers.reserve(std::max<std::ptrdiff_t>(0, threads - 1));
+    for (std::ptrdiff_t i = 1; i < threads; ++i) {
+        workers.emplace_back(runWorker, &search);
+    }
+    runWorker(&search);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (Slitherlink* branch : branches) {
+        delete branch;
+    }
+    return std::min<std::ptrdiff_t>(search.no_of_solutions, limit);
+}
+
+bool isUniqueParallel(Slitherlink* slitherlink, std::ptrdiff_t threads){
+    return countSolutionsParallel(slitherlink, 2, threads) == 1;
+}
@@ -1,98 +1,314 @@
 #include "../api/solver.hpp"
 #include "../../utilities/api/trace_lib.hpp"
+#include "../../model/model_CPP/api/parser.hpp"
 
 #include <cassert>
-#include <random>
 #include <algorithm>
 
 Solver::Solver() {
-
+    this->original_slitherlink = nullptr;
+    this->slitherlink = nullptr;
 }
 
 Solver::~Solver() {
+    clearSearchState();
+}
+
+void Solver::clearSearchState() {
     delete slitherlink;
+    slitherlink = nullptr;
+    clearGuesses();
+}
+
+void Solver::clearGuesses() {
     for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)slitherlink_queue.size(); ++i) {
-        delete slitherlink_queue[i]->slitherlink;
         delete slitherlink_queue[i];
     }
+    slitherlink_queue.clear();
+    queue.clear();
+    search_nodes.clear();
 }
 
 void Solver::solvePuzzle(Slitherlink* new_slitherlink,
                          std::vector<Slitherlink*>* slitherlink_solution) {
-    
+    startSolving(new_slitherlink);
+
+    Slitherlink* solution = nextSolution();
+    while (solution != nullptr) {
+        LOG("Solution found");
+        slitherlink_solution->push_back(solution->copy());
+        solution->savePuzzle("solver_solution" + std::to_string(slitherlink_solution->size()) + ".txt");
+        solution = nextSolution();
+    }
+}
+
+void Solver::startSolving(Slitherlink* new_slitherlink) {
+    clearSearchState();
+
     this->original_slitherlink = new_slitherlink;
     this->slitherlink = new_slitherlink->copy();
 
-    this->faces_solved.resize(slitherlink->no_of_faces, false);
-    this->vertices_solved.resize(slitherlink->no_of_vertices, false);
-    this->slitherlink_queue.clear();
-    this->queue.clear();
     this->queue.reserve(slitherlink->no_of_faces + slitherlink->no_of_vertices);
-    this->edge_to_loop_part.clear();
-    this->edge_to_loop_part.resize(slitherlink->no_of_edges, -1);
+    this->edge_is_assumption.assign(slitherlink->no_of_edges, false);
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
+        edge_is_assumption[i] = slitherlink->edges[i]->solution != EDGE_UNKNOWN;
+    }
+    this->fixed_hex_size = getFixedHexSize(slitherlink);
+    this->solution_pending = false;
+    this->no_of_solutions = 0;
+    this->solution_limit = -1;
+    this->skip_known_solutions = false;
+    this->search_finished = !seedPropagation();
+}
+
+void Solver::setTranspositionTable(TranspositionTable* table) {
+    this->transposition_table = table;
+}
+
+void Solver::setStopFlag(const std::atomic<bool>* flag) {
+    this->stop_flag = flag;
+}
+
+/**
+ * Mix next value into key, so order of values matters.
+ */
+static std::uint64_t mixKey(std::uint64_t key, std::uint64_t value) {
+    return zobristKey(key ^ value);
+}
+
+std::uint64_t Solver::getNodeKey() {
+    // Solutions below node depend only on undecided edges, clues left for
+    // their faces and how loop ends are paired, decided region is consistent
+    // after propagation. Each value is tagged by its kind, so keys of
+    // different regions don't mix.
+    std::uint64_t key = zobristKey((std::uint64_t)slitherlink->no_of_edges << 32 |
+                                   (std::uint64_t)slitherlink->no_of_faces);
+    for (slitherlink_edge* edge_p : slitherlink->edges) {
+        if (edge_p->solution == EDGE_UNKNOWN) {
+            key = mixKey(key, (std::uint64_t)edge_p->id << 2);
+        }
+    }
+    for (slitherlink_face* face_p : slitherlink->faces) {
+        if (face_p->id == OUTER_FACE || face_p->value == FACE_NO_VALUE) {
+            continue;
+        }
+        std::ptrdiff_t value_left = face_p->value;
+        bool has_unknown_edge = false;
+        for (slitherlink_edge* edge_p : face_p->edge_refs) {
+            value_left -= edge_p->solution == EDGE_IN_SOLUTION ? 1 : 0;
+            has_unknown_edge = has_unknown_edge || edge_p->solution == EDGE_UNKNOWN;
+        }
+        if (has_unknown_edge) {
+            key = mixKey(key, (std::uint64_t)face_p->id << 2 | 1);
+            key = mixKey(key, (std::uint64_t)value_left);
+        }
+    }
+    // loop ends are labelled by order of their parts, so only pairing counts
+    std::vector<std::ptrdiff_t> part_labels(max_loop_part_id + 1, -1);
+    std::ptrdiff_t no_of_labels = 0;
+    for (slitherlink_vertex* vertex_p : slitherlink->vertices) {
+        // only edge in solution, there is no loop end on -1 or -2
+        std::ptrdiff_t edge_id = getLoopNeighbour(vertex_p, -1);
+        if (edge_id < 0) {
+            continue;
+        }
+        std::ptrdiff_t& label = part_labels[edge_to_loop_part[edge_id]];
+        if (label == -1) {
+            label = no_of_labels++;
+        }
+        key = mixKey(key, (std::uint64_t)vertex_p->id << 2 | 2);
+        key = mixKey(key, (std::uint64_t)label);
+    }
+    return key;
+}
+
+bool Solver::isKnownNode() {
+    if (transposition_table == nullptr) {
+        return false;
+    }
+    node_key = getNodeKey();
+    std::ptrdiff_t node_solutions = 0;
+    if (!transposition_table->probe(node_key, &node_solutions)) {
+        return false;
+    }
+    if (node_solutions == 0) {
+        LOG("Node without solutions found in transposition table");
+        return true;
+    }
+    if (skip_known_solutions) {
+        LOG("Node with ", node_solutions, " solutions found in transposition table");
+        no_of_solutions += node_solutions;
+        return true;
+    }
+    return false;
+}
 
+void Solver::finishSearchNodes() {
+    while (!search_nodes.empty() &&
+           search_nodes.back().depth >= (std::ptrdiff_t)slitherlink_queue.size()) {
+        search_node& node = search_nodes.back();
+        transposition_table->store(node.hash, no_of_solutions - node.no_of_solutions);
+        search_nodes.pop_back();
+    }
+}
 
+bool Solver::seedPropagation() {
+    this->faces_solved.assign(slitherlink->no_of_faces, false);
+    this->vertices_solved.assign(slitherlink->no_of_vertices, false);
+    this->edge_to_loop_part.assign(slitherlink->no_of_edges, -1);
+    this->max_loop_part_id = -1;
+    this->no_of_loop_parts = 0;
+    this->edge_cause.assign(slitherlink->no_of_edges,
+                            std::make_pair(QUEUE_ITEM_NONE, (std::ptrdiff_t)-1));
+    this->edge_order.assign(slitherlink->no_of_edges, -1);
+    this->next_edge_order = 0;
+    this->queue.clear();
+    this->edge_solutions.assign(slitherlink->no_of_edges, EDGE_UNKNOWN);
+
+    // Known edges are fixed assumptions - propagate from them
     for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
-        slitherlink->edges[i]->solution = EDGE_UNKNOWN;
+        slitherlink_edge* edge_p = slitherlink->edges[i];
+        if (!edge_is_assumption[i]) {
+            edge_p->solution = EDGE_UNKNOWN;
+            continue;
+        }
+        edge_solutions[i] = edge_p->solution;
+        edge_order[i] = next_edge_order++;
+        if (edge_p->solution == EDGE_IN_SOLUTION && !addToLoops(i)) {
+            ERROR("Known edge ", i, " contradicts other known edges");
+            return false;
+        }
+        push_edge(edge_p);
+    }
+    // Clues can give deductions on their own, e.g. face with value 0
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_faces; ++i) {
+        slitherlink_face* face_p = slitherlink->faces[i];
+        if (face_p->id != OUTER_FACE &&
+            face_p->value != FACE_NO_VALUE &&
+            !faces_solved[face_p->id]) {
+            queue.push_back(std::make_pair(QUEUE_ITEM_FACE, face_p->id));
+        }
     }
+    return true;
+}
 
-    std::ptrdiff_t step_count = 0;
+bool Solver::propagate() {
+    // puzzles on hexagonal grid of usual sizes use compile-time adjacency
+    if (fixed_hex_size != 0) {
+        return withHexTopology(fixed_hex_size, [this](const auto& topology){
+            return propagate(topology);
+        });
+    }
+    return propagate(SlitherlinkTopology(slitherlink));
+}
+
+template<typename Topology>
+bool Solver::propagate(const Topology& topology) {
+    LOG_DEBUG("Queue size: ", queue.size());
+    while (!queue.empty()) {
+        bool is_correct = false;
+        auto item = pop();
+        if (item.first == QUEUE_ITEM_FACE) {
+            is_correct = updateFaceEdges(topology, item.second);
+            LOG("Face ", item.second, " updated");
+        }
+        else if (item.first == QUEUE_ITEM_VERTEX) {
+            is_correct = updateVertexEdges(topology, item.second);
+            LOG("Vertex ", item.second, " updated");
+        }
+        else {
+            ERROR("Unknown item type in queue");
+        }
+        if (!is_correct) {
+            LOG("Guess was incorrect - dropping queue");
+            return false;
+        }
+    }
+    return true;
+}
 
-    bool can_continue = true;
+void Solver::setEdgeSolution(slitherlink_edge* edge_p, slitherlink_edge_type solution) {
+    edge_p->solution = solution;
+    edge_solutions[edge_p->id] = solution;
+}
+
+void Solver::assignEdge(slitherlink_edge* edge_p,
+                        slitherlink_edge_type solution,
+                        std::pair<queue_item_type, std::ptrdiff_t> cause) {
+    if (is_probing) {
+        probe_edge_ids.push_back(edge_p->id);
+    }
+    setEdgeSolution(edge_p, solution);
+    edge_cause[edge_p->id] = cause;
+    edge_order[edge_p->id] = next_edge_order++;
+    push_edge(edge_p);
+}
 
-    while ((!isSolved() || !slitherlink_queue.empty()) && can_continue) {
+Slitherlink* Solver::nextSolution() {
+    if (slitherlink == nullptr || search_finished) {
+        return nullptr;
+    }
+
+    // Previous call stopped at a solution - continue from the last guess
+    if (solution_pending) {
+        solution_pending = false;
+        if (!restoreGuess()) {
+            search_finished = true;
+            return nullptr;
+        }
+    }
+
+    while (true) {
         LOG_DEBUG("Solving puzzle");
-        if (isSolved()) {
-            LOG("Solution found");
-            slitherlink_solution->push_back(slitherlink->copy());
-            slitherlink->savePuzzle("solver_solution" + std::to_string(slitherlink_solution->size()) + ".txt");
-            restoreGuess();
+        if (stop_flag != nullptr && stop_flag->load(std::memory_order_relaxed)) {
+            LOG("Search stopped by flag");
+            search_finished = true;
+            return nullptr;
         }
         bool is_correct = true;
         if (queue.empty()) {
-            is_correct = addToLoops(makeGuess());
-        }
-        LOG_DEBUG("Queue size: ", queue.size());
-        while(is_correct && !queue.empty()) {
-            std::ptrdiff_t edges_in_solution = 0;
-            std::ptrdiff_t edges_not_in_solution = 0;
-            for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
-                if (slitherlink->edges[i]->solution == EDGE_IN_SOLUTION) {
-                    edges_in_solution++;
-                }
-                else if (slitherlink->edges[i]->solution == EDGE_NOT_IN_SOLUTION) {
-                    edges_not_in_solution++;
-                }
+            if (isSolved()) {
+                LOG("Solution found");
+                fillUnknownEdges();
+                slitherlink->params_bitmap |= SOLVED_EDGE_BIT_PRESENT;
+                no_of_solutions++;
+                solution_pending = true;
+                return slitherlink;
             }
-
-            auto item = pop();
-            if (item.first == QUEUE_ITEM_FACE) {
-                is_correct = updateFaceEdges(item.second);
-                LOG("Face ", item.second, " updated");
+            is_correct = probeEdges();
+            // probing can complete the loop
+            if (is_correct && isSolved()) {
+                continue;
             }
-            else if (item.first == QUEUE_ITEM_VERTEX) {
-                is_correct = updateVertexEdges(item.second);
-                LOG("Vertex ", item.second, " updated");
+            if (!is_correct) {
+                LOG("Probing found contradiction");
             }
-            else {
-                ERROR("Unknown item type in queue");
-                return;
+            else if (isKnownNode()) {
+                is_correct = false;
+                if (solution_limit != -1 && no_of_solutions >= solution_limit) {
+                    search_finished = true;
+                    return nullptr;
+                }
             }
-            // slitherlink->savePuzzle("solver_step_count" + std::to_string(step_count) + ".txt");
-            if (!is_correct) {
-                LOG("Guess was incorrect - dropping queue");
-                break;
+            else {
+                is_correct = addToLoops(makeGuess());
             }
+        }
+        if (is_correct) {
+            is_correct = propagate();
+        }
 
+        if (!is_correct && !restoreGuess()) {
+            search_finished = true;
+            return nullptr;
         }
-        step_count++;
+    }
+}
 
-        if (!is_correct) {
-            // slitherlink->savePuzzle("solver_step_count" + std::to_string(step_count) + ".txt");
-            // LOG("Guess was incorrect - restoring state before last guess after step: ", step_count);
-            can_continue =  restoreGuess();
-            // slitherlink->savePuzzle("solver_step_count" + std::to_string(step_count) + "_restored.txt");
-            // break;
+void Solver::fillUnknownEdges() {
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
+        if (slitherlink->edges[i]->solution == EDGE_UNKNOWN) {
+            setEdgeSolution(slitherlink->edges[i], EDGE_NOT_IN_SOLUTION);
         }
     }
 }
@@ -129,34 +345,63 @@ bool Solver::isSolved() {
                 no_of_faces_in_solution++;
             }
         }
-        if (no_of_faces_in_solution != slitherlink->faces[i]->value) {
+        if (slitherlink->faces[i]->value != FACE_NO_VALUE &&
+            no_of_faces_in_solution != slitherlink->faces[i]->value) {
+            return false;
+        }
+    }
+    // clue counts alone do not guarantee a single closed loop
+    if (no_of_loop_parts != 1) {
+        return false;
+    }
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_vertices; i++) {
+        std::ptrdiff_t edges_in_solution = 0;
+        for (slitherlink_edge* edge_p : slitherlink->vertices[i]->edge_refs) {
+            if (edge_p->solution == EDGE_IN_SOLUTION) {
+                edges_in_solution++;
+            }
+        }
+        if (edges_in_solution != 0 && edges_in_solution != 2) {
             return false;
         }
     }
     return true;
 }
 
+std::ptrdiff_t Solver::getLoopNeighbour(slitherlink_vertex* vertex_p,
+                                        std::ptrdiff_t edge_id) {
+    std::ptrdiff_t neighbour_id = -1;
+    for (slitherlink_edge* edge_p : vertex_p->edge_refs) {
+        if (edge_p->id == edge_id || edge_p->solution != EDGE_IN_SOLUTION) {
+            continue;
+        }
+        if (neighbour_id != -1) {
+            return -2;
+        }
+        neighbour_id = edge_p->id;
+    }
+    return neighbour_id;
+}
+
+void Solver::setLoopPart(std::ptrdiff_t edge_id, std::ptrdiff_t part_id) {
+    if (is_probing) {
+        probe_loop_parts.push_back(std::make_pair(edge_id, edge_to_loop_part[edge_id]));
+    }
+    edge_to_loop_part[edge_id] = part_id;
+}
+
 bool Solver::addToLoops(std::ptrdiff_t edge_id) {
     if (edge_id == -1) {
         return false;
     }
     slitherlink_vertex* vertex_0 = slitherlink->vertices[slitherlink->edges[edge_id]->vertices[0]];
     slitherlink_vertex* vertex_1 = slitherlink->vertices[slitherlink->edges[edge_id]->vertices[1]];
-    std::ptrdiff_t first_edge_id = -1;
-    std::ptrdiff_t second_edge_id = -1;
-
-    if (vertex_0->edge_refs[0]->solution == EDGE_IN_SOLUTION) {
-        first_edge_id = vertex_0->edge_refs[0]->id;
-    }
-    else if (vertex_0->edge_refs[1]->solution == EDGE_IN_SOLUTION) {
-        first_edge_id = vertex_0->edge_refs[1]->id;
-    }
+    std::ptrdiff_t first_edge_id = getLoopNeighbour(vertex_0, edge_id);
+    std::ptrdiff_t second_edge_id = getLoopNeighbour(vertex_1, edge_id);
 
-    if (vertex_1->edge_refs[0]->solution == EDGE_IN_SOLUTION) {
-        second_edge_id = vertex_1->edge_refs[0]->id;
-    }
-    else if (vertex_1->edge_refs[1]->solution == EDGE_IN_SOLUTION) {
-        second_edge_id = vertex_1->edge_refs[1]->id;
+    if (first_edge_id == -2 || second_edge_id == -2) {
+        LOG("Edge: ", edge_id, " creates branching of loop");
+        return false;
     }
 
     std::ptrdiff_t first_part_id = first_edge_id != -1 ?
@@ -169,15 +414,15 @@ bool Solver::addToLoops(std::ptrdiff_t edge_id) {
     if (first_part_id == -1 && second_part_id == -1) {
         max_loop_part_id++;
         no_of_loop_parts++;
-        edge_to_loop_part[edge_id] = max_loop_part_id;
+        setLoopPart(edge_id, max_loop_part_id);
         LOG("New loop part: ", max_loop_part_id, " for edge: ", edge_id);
     }
     else if (first_part_id == -1 && second_part_id != -1) {
-        edge_to_loop_part[edge_id] = second_part_id;
+        setLoopPart(edge_id, second_part_id);
         LOG("Edge: ", edge_id, " is in loop part: ", second_part_id);
     }
     else if (first_part_id != -1 && second_part_id == -1) {
-        edge_to_loop_part[edge_id] = first_part_id;
+        setLoopPart(edge_id, first_part_id);
         LOG("Edge: ", edge_id, " is in loop part: ", first_part_id);
     }
     else if (first_part_id != -1 && second_part_id != -1) {
@@ -187,7 +432,7 @@ bool Solver::addToLoops(std::ptrdiff_t edge_id) {
                 return false;
             }
             else {
-                edge_to_loop_part[edge_id] = first_part_id;
+                setLoopPart(edge_id, first_part_id);
                 LOG("Edge: ", edge_id, " is in closed loop: ", first_part_id);
                 return isSolved();
             }
@@ -195,16 +440,84 @@ bool Solver::addToLoops(std::ptrdiff_t edge_id) {
         else {
             for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
                 if (edge_to_loop_part[i] == second_part_id) {
-                    edge_to_loop_part[i] = first_part_id;
+                    setLoopPart(i, first_part_id);
                 }
             }
-            edge_to_loop_part[edge_id] = first_part_id;
+            setLoopPart(edge_id, first_part_id);
+            no_of_loop_parts--;
             LOG("Edge: ", edge_id, " is in last loop part: ", first_part_id);
         }
     }
     return true;
 }
 
+bool Solver::probeEdge(slitherlink_edge* edge_p, slitherlink_edge_type solution) {
+    std::ptrdiff_t saved_max_loop_part_id = max_loop_part_id;
+    std::ptrdiff_t saved_no_of_loop_parts = no_of_loop_parts;
+    std::ptrdiff_t saved_next_edge_order = next_edge_order;
+    is_probing = true;
+    probe_edge_ids.clear();
+    probe_loop_parts.clear();
+
+    assignEdge(edge_p, solution, std::make_pair(QUEUE_ITEM_NONE, (std::ptrdiff_t)-1));
+    bool is_correct = (solution != EDGE_IN_SOLUTION || addToLoops(edge_p->id)) &&
+                      propagate();
+
+    // faces and vertices of probed edges were not solved before
+    queue.clear();
+    is_probing = false;
+    for (std::ptrdiff_t i = probe_loop_parts.size() - 1; i >= 0; --i) {
+        edge_to_loop_part[probe_loop_parts[i].first] = probe_loop_parts[i].second;
+    }
+    for (std::ptrdiff_t edge_id : probe_edge_ids) {
+        slitherlink_edge* probed_edge_p = slitherlink->edges[edge_id];
+        setEdgeSolution(probed_edge_p, EDGE_UNKNOWN);
+        edge_cause[edge_id] = std::make_pair(QUEUE_ITEM_NONE, (std::ptrdiff_t)-1);
+        edge_order[edge_id] = -1;
+        for (std::ptrdiff_t i = 0; i < 2; ++i) {
+            if (probed_edge_p->face_ids[i] != OUTER_FACE) {
+                faces_solved[probed_edge_p->face_ids[i]] = false;
+            }
+            vertices_solved[probed_edge_p->vertices[i]] = false;
+        }
+    }
+    max_loop_part_id = saved_max_loop_part_id;
+    no_of_loop_parts = saved_no_of_loop_parts;
+    next_edge_order = saved_next_edge_order;
+    return is_correct;
+}
+
+bool Solver::probeEdges() {
+    probe_guess_edge_id = -1;
+    std::ptrdiff_t best_score = -1;
+    for (slitherlink_edge* edge_p : slitherlink->edges) {
+        if (edge_p->solution != EDGE_UNKNOWN) {
+            continue;
+        }
+        std::ptrdiff_t score = 1;
+        for (slitherlink_edge_type solution : {EDGE_IN_SOLUTION, EDGE_NOT_IN_SOLUTION}) {
+            if (probeEdge(edge_p, solution)) {
+                score *= probe_edge_ids.size();
+                if (solution == EDGE_NOT_IN_SOLUTION && score > best_score) {
+                    best_score = score;
+                    probe_guess_edge_id = edge_p->id;
+                }
+                continue;
+            }
+            // the other value is forced, keep it and probe further from there
+            slitherlink_edge_type other = solution == EDGE_IN_SOLUTION ?
+                                          EDGE_NOT_IN_SOLUTION :
+                                          EDGE_IN_SOLUTION;
+            assignEdge(edge_p, other, std::make_pair(QUEUE_ITEM_NONE, (std::ptrdiff_t)-1));
+            if ((other == EDGE_IN_SOLUTION && !addToLoops(edge_p->id)) || !propagate()) {
+                return false;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
 std::ptrdiff_t Solver::makeGuess() {
 
     solver_state* state = new solver_state;
@@ -227,21 +540,26 @@ std::ptrdiff_t Solver::makeGuess() {
     // assert(no_of_unknown_edges > 0);
     if (no_of_unknown_edges == 0) {
         ERROR("No unknown edges");
-        slitherlink->savePuzzle("solver_no_unknown_edges.txt");
         delete state;
         return -1;
     }
 
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(1, no_of_unknown_edges);
-    std::ptrdiff_t random_edge = distrib(gen);
-    std::ptrdiff_t edge_id = -1;
-    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; i++) {
-        if (slitherlink->edges[i]->solution == EDGE_UNKNOWN) {
-            random_edge--;
-            if (random_edge == 0) {
+    // edge whose both values assigned the most edges when probed splits
+    // search best, otherwise extending loop end fails fast
+    std::ptrdiff_t edge_id = probe_guess_edge_id;
+    if (edge_id == -1 || slitherlink->edges[edge_id]->solution != EDGE_UNKNOWN) {
+        edge_id = -1;
+        for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; i++) {
+            slitherlink_edge* edge_p = slitherlink->edges[i];
+            if (edge_p->solution != EDGE_UNKNOWN) {
+                continue;
+            }
+            if (edge_id == -1) {
+                edge_id = i;
+            }
+            if (getLoopNeighbour(slitherlink->vertices[edge_p->vertices[0]], i) >= 0 ||
+                getLoopNeighbour(slitherlink->vertices[edge_p->vertices[1]], i) >= 0) {
                 edge_id = i;
                 break;
             }
@@ -250,23 +568,25 @@ std::ptrdiff_t Solver::makeGuess() {
 
     assert(edge_id != -1);
 
-    state->slitherlink = slitherlink->copy();
+    if (transposition_table != nullptr) {
+        search_nodes.push_back(search_node{
+            .hash = node_key,
+            .depth = (std::ptrdiff_t)slitherlink_queue.size(),
+            .no_of_solutions = no_of_solutions
+        });
+    }
+
+    saveState(state);
     state->edge_id = edge_id;
     state->edge_solution = EDGE_IN_SOLUTION;
-    state->faces_solved = std::vector<bool>(faces_solved);
-    state->vertices_solved = std::vector<bool>(vertices_solved);
-    state->edge_to_loop_part = std::vector<std::ptrdiff_t>(edge_to_loop_part);
-    state->max_loop_part_id = max_loop_part_id;
-    state->no_of_loop_parts = no_of_loop_parts;
     slitherlink_queue.push_back(state);
 
     // Possible TODO: randomize guess
-    slitherlink->edges[edge_id]->solution = EDGE_IN_SOLUTION;
+    assignEdge(slitherlink->edges[edge_id], EDGE_IN_SOLUTION,
+               std::make_pair(QUEUE_ITEM_NONE, (std::ptrdiff_t)-1));
 
     LOG("Guessing edge ", edge_id, " to be in solution: ", slitherlink->edges[edge_id]->solution);
 
-    push_edge(slitherlink->edges[edge_id]);
-
     return edge_id;
 
     // queue.push_back(std::make_pair(QUEUE_ITEM_FACE,
@@ -279,161 +599,172 @@ std::ptrdiff_t Solver::makeGuess() {
     //                                slitherlink->edges[edge_id]->vertices[1]));
 }
 
-bool Solver::restoreGuess() {
-    if (slitherlink_queue.empty()) {
-        ERROR("No more guesses to restore");
-        return false;
-    }
-
-    delete slitherlink;
+void Solver::saveState(solver_state* state) {
+    // clues do not change during search, so only edges are saved
+    state->edge_solutions = edge_solutions;
+    state->faces_solved = faces_solved;
+    state->vertices_solved = vertices_solved;
+    state->edge_to_loop_part = edge_to_loop_part;
+    state->max_loop_part_id = max_loop_part_id;
+    state->no_of_loop_parts = no_of_loop_parts;
+    state->edge_cause = edge_cause;
+    state->edge_order = edge_order;
+    state->next_edge_order = next_edge_order;
+}
 
-    solver_state* state = slitherlink_queue.back();
-    slitherlink_queue.pop_back();
-    slitherlink = state->slitherlink;
+void Solver::loadState(solver_state* state) {
+    for (std::ptrdiff_t i = 0; i < slitherlink->no_of_edges; ++i) {
+        slitherlink->edges[i]->solution = state->edge_solutions[i];
+    }
+    edge_solutions = state->edge_solutions;
+    faces_solved = state->faces_solved;
+    vertices_solved = state->vertices_solved;
     edge_to_loop_part = state->edge_to_loop_part;
     max_loop_part_id = state->max_loop_part_id;
     no_of_loop_parts = state->no_of_loop_parts;
-    faces_solved = state->faces_solved;
-    vertices_solved = state->vertices_solved;
+    edge_cause = state->edge_cause;
+    edge_order = state->edge_order;
+    next_edge_order = state->next_edge_order;
+}
 
-    slitherlink->edges[state->edge_id]->solution = (state->edge_solution == EDGE_IN_SOLUTION) ?
-        EDGE_NOT_IN_SOLUTION : EDGE_IN_SOLUTION;
-    
-    queue.clear();
+bool Solver::restoreGuess() {
+    while (!slitherlink_queue.empty()) {
+        // nodes whose both guesses were explored are finished
+        finishSearchNodes();
 
-    push_edge(slitherlink->edges[state->edge_id]);
+        solver_state* state = slitherlink_queue.back();
+        slitherlink_queue.pop_back();
+        loadState(state);
 
-    delete state;
+        std::ptrdiff_t edge_id = state->edge_id;
+        setEdgeSolution(slitherlink->edges[edge_id],
+                        (state->edge_solution == EDGE_IN_SOLUTION) ?
+                            EDGE_NOT_IN_SOLUTION : EDGE_IN_SOLUTION);
 
-    return true;
-}
-
-bool Solver::updateFaceEdges(std::ptrdiff_t face_id) {
+        queue.clear();
 
-    slitherlink_face* face = slitherlink->faces[face_id];
+        delete state;
 
-    if (face->value == 0) {
-        for (std::ptrdiff_t i = 0; i < face->no_of_edges; ++i) {
-            if (face->edge_refs[i]->solution == EDGE_IN_SOLUTION) {
-                ERROR("Face with value 0 has edge in solution");
-                return false;
-            }
-            if (face->edge_refs[i]->solution == EDGE_UNKNOWN) {
-                face->edge_refs[i]->solution = EDGE_NOT_IN_SOLUTION;
-                push_edge(face->edge_refs[i]);
-                LOG("Push from face");
-            }
+        if (slitherlink->edges[edge_id]->solution == EDGE_IN_SOLUTION &&
+            !addToLoops(edge_id)) {
+            LOG("Alternative of guess ", edge_id, " is incorrect as well");
+            continue;
         }
+
+        push_edge(slitherlink->edges[edge_id]);
+
+        return true;
+    }
+    finishSearchNodes();
+    ERROR("No more guesses to restore");
+    return false;
+}
+
+template<typename Topology>
+bool Solver::updateFaceEdges(const Topology& topology, std::ptrdiff_t face_id) {
+    std::ptrdiff_t value = slitherlink->faces[face_id]->value;
+    std::pair<queue_item_type, std::ptrdiff_t> cause = std::make_pair(QUEUE_ITEM_FACE, face_id);
+
+    if (value == FACE_NO_VALUE) {
         return true;
     }
 
     std::ptrdiff_t edges_in_solution = 0;
     std::ptrdiff_t edges_unknown = 0;
-    for (std::ptrdiff_t i = 0; i < face->no_of_edges; ++i) {
-        if (face->edge_refs[i]->solution == EDGE_IN_SOLUTION) {
-            edges_in_solution++;
-        }
-        else if (face->edge_refs[i]->solution == EDGE_UNKNOWN) {
-            edges_unknown++;
-        }
-    }
+    topology.forEachFaceEdge(face_id, [&](std::ptrdiff_t edge_id){
+        slitherlink_edge_type solution = edge_solutions[edge_id];
+        edges_in_solution += solution == EDGE_IN_SOLUTION ? 1 : 0;
+        edges_unknown += solution == EDGE_UNKNOWN ? 1 : 0;
+    });
 
-    if (edges_in_solution > face->value) {
+    if (edges_in_solution > value) {
         ERROR("Face ", face_id, " has too many edges in solution: ",
-              edges_in_solution, " > ", face->value);
+              edges_in_solution, " > ", value);
+        return false;
+    }
+    if (edges_in_solution + edges_unknown < value) {
+        ERROR("Face ", face_id, " has too few edges left: ",
+              edges_in_solution + edges_unknown, " < ", value);
         return false;
     }
 
 
     LOG("Face ", face_id, " edges in solution: ", edges_in_solution,
         " edges unknown: ", edges_unknown);
-    if (edges_in_solution == face->value) {
-        for (std::ptrdiff_t i = 0; i < face->no_of_edges; ++i) {
-            LOG("Face ", face_id, " edge id", face->edge_refs[i]->id);
-            if (face->edge_refs[i]->solution == EDGE_UNKNOWN) {
-                face->edge_refs[i]->solution = EDGE_NOT_IN_SOLUTION;
-                push_edge(face->edge_refs[i]);
-                LOG("Push from face - edge not in solution");
-            }
-        }
+    if (edges_unknown == 0) {
+        return true;
     }
-    else if (edges_in_solution + edges_unknown == face->value) {
-        for (std::ptrdiff_t i = 0; i < face->no_of_edges; ++i) {
-            LOG("Face ", face_id, " edge id", face->edge_refs[i]->id);
-            if (face->edge_refs[i]->solution == EDGE_UNKNOWN) {
-                face->edge_refs[i]->solution = EDGE_IN_SOLUTION;
-                push_edge(face->edge_refs[i]);
-                LOG("Push from face - edge in solution");
-                if (!addToLoops(face->edge_refs[i]->id)) {
-                    ERROR("Face ", face_id, " edge id", face->edge_refs[i]->id,
-                          " creates wrong looping");
-                    return false;
-                }
-            }
-        }
+    // unknown edges are all out once clue is met, or all in if it needs them all
+    slitherlink_edge_type solution = edges_in_solution == value ? EDGE_NOT_IN_SOLUTION :
+                                     edges_in_solution + edges_unknown == value ? EDGE_IN_SOLUTION :
+                                     EDGE_UNKNOWN;
+    if (solution == EDGE_UNKNOWN) {
+        return true;
     }
-    return true;
+    bool is_correct = true;
+    topology.forEachFaceEdge(face_id, [&](std::ptrdiff_t edge_id){
+        if (!is_correct || edge_solutions[edge_id] != EDGE_UNKNOWN) {
+            return;
+        }
+        assignEdge(slitherlink->edges[edge_id], solution, cause);
+        LOG("Push from face - edge ", edge_id, " solution ", solution);
+        if (solution == EDGE_IN_SOLUTION && !addToLoops(edge_id)) {
+            ERROR("Face ", face_id, " edge id", edge_id, " creates wrong looping");
+            is_correct = false;
+        }
+    });
+    return is_correct;
 }
 
-bool Solver::updateVertexEdges(std::ptrdiff_t vertex_id) {
-    slitherlink_vertex* vertex = slitherlink->vertices[vertex_id];
+template<typename Topology>
+bool Solver::updateVertexEdges(const Topology& topology, std::ptrdiff_t vertex_id) {
+    std::pair<queue_item_type, std::ptrdiff_t> cause = std::make_pair(QUEUE_ITEM_VERTEX, vertex_id);
 
+    std::ptrdiff_t no_of_edges = 0;
     std::ptrdiff_t edges_in_solution = 0;
     std::ptrdiff_t edges_unknown = 0;
-    std::ptrdiff_t edges_not_in_solution = 0;
-    for (std::ptrdiff_t i = 0; i < vertex->no_of_edges; ++i) {
-        if (vertex->edge_refs[i]->solution == EDGE_IN_SOLUTION) {
-            edges_in_solution++;
-        }
-        else if (vertex->edge_refs[i]->solution == EDGE_UNKNOWN) {
-            edges_unknown++;
-        }
-        else if (vertex->edge_refs[i]->solution == EDGE_NOT_IN_SOLUTION) {
-            edges_not_in_solution++;
-        }
-    }
+    topology.forEachVertexEdge(vertex_id, [&](std::ptrdiff_t edge_id){
+        slitherlink_edge_type solution = edge_solutions[edge_id];
+        no_of_edges++;
+        edges_in_solution += solution == EDGE_IN_SOLUTION ? 1 : 0;
+        edges_unknown += solution == EDGE_UNKNOWN ? 1 : 0;
+    });
+    std::ptrdiff_t edges_not_in_solution = no_of_edges - edges_in_solution - edges_unknown;
     if (edges_in_solution > 2) {
         ERROR("Vertex has more than 2 edges in solution");
         return false;
     }
+    if (edges_in_solution == 1 && edges_unknown == 0) {
+        ERROR("Vertex ", vertex_id, " is a dead end of loop");
+        return false;
+    }
 
     LOG("Vertex ", vertex_id, " edges in solution: ", edges_in_solution,
         " edges unknown: ", edges_unknown);
 
-    if (edges_unknown > 0) {
-        if (edges_in_solution == 2) {
-            for (std::ptrdiff_t i = 0; i < vertex->no_of_edges; ++i) {
-                if (vertex->edge_refs[i]->solution == EDGE_UNKNOWN) {
-                    vertex->edge_refs[i]->solution = EDGE_NOT_IN_SOLUTION;
-                    push_edge(vertex->edge_refs[i]);
-                    LOG("Push from vertex");
-                }
-            }
-        }
-        else if ((edges_in_solution == 1) &&
-                 (edges_unknown == 1)) {
-            for (std::ptrdiff_t i = 0; i < vertex->no_of_edges; ++i) {
-                if (vertex->edge_refs[i]->solution == EDGE_UNKNOWN) {
-                    vertex->edge_refs[i]->solution = EDGE_IN_SOLUTION;
-                    push_edge(vertex->edge_refs[i]);
-                    LOG("Push from vertex");
-                    if (!addToLoops(vertex->edge_refs[i]->id)) {
-                        ERROR("Vertex ", vertex_id, " edge id", vertex->edge_refs[i]->id,
-                              " creates wrong looping");
-                        return false;
-                    }
-                }
-            }
+    if (edges_unknown == 0) {
+        return true;
+    }
+    // full vertex and vertex that can't be passed drop the rest,
+    // loop end with one way out has to take it
+    slitherlink_edge_type solution = edges_in_solution == 2 ? EDGE_NOT_IN_SOLUTION :
+                                     edges_in_solution == 1 && edges_unknown == 1 ? EDGE_IN_SOLUTION :
+                                     no_of_edges - edges_not_in_solution == 1 ? EDGE_NOT_IN_SOLUTION :
+                                     EDGE_UNKNOWN;
+    if (solution == EDGE_UNKNOWN) {
+        return true;
+    }
+    bool is_correct = true;
+    topology.forEachVertexEdge(vertex_id, [&](std::ptrdiff_t edge_id){
+        if (!is_correct || edge_solutions[edge_id] != EDGE_UNKNOWN) {
+            return;
         }
-        else if (vertex->no_of_edges - edges_not_in_solution == 1) {
-            for (std::ptrdiff_t i = 0; i < vertex->no_of_edges; ++i) {
-                if (vertex->edge_refs[i]->solution == EDGE_UNKNOWN) {
-                    vertex->edge_refs[i]->solution = EDGE_NOT_IN_SOLUTION;
-                    push_edge(vertex->edge_refs[i]);
-                    LOG("Push from vertex");
-                }
-            }
+        assignEdge(slitherlink->edges[edge_id], solution, cause);
+        LOG("Push from vertex - edge ", edge_id, " solution ", solution);
+        if (solution == EDGE_IN_SOLUTION && !addToLoops(edge_id)) {
+            ERROR("Vertex ", vertex_id, " edge id", edge_id, " creates wrong looping");
+            is_correct = false;
         }
-    }
-    return true;
+    });
+    return is_correct;
 }
@@ -0,0 +1,187 @@
+#include "../api/solver.hpp"
+#include "../../utilities/api/trace_lib.hpp"
+
+#include <algorithm>
+
+bool Solver::startEditing(Slitherlink* new_slitherlink) {
+    startSolving(new_slitherlink);
+    root_consistent = !search_finished && propagate();
+    if (!root_consistent) {
+        queue.clear();
+    }
+    return root_consistent;
+}
+
+bool Solver::setClue(std::ptrdiff_t face_id, std::ptrdiff_t value) {
+    return editClue(face_id, value);
+}
+
+bool Solver::clearClue(std::ptrdiff_t face_id) {
+    return editClue(face_id, FACE_NO_VALUE);
+}
+
+bool Solver::isUnique() {
+    return countSolutions(2) == 1;
+}
+
+Slitherlink* Solver::copyPropagated() {
+    if (slitherlink == nullptr || !root_consistent) {
+        return nullptr;
+    }
+    return slitherlink->copy();
+}
+
+std::ptrdiff_t Solver::countSolutions(std::ptrdiff_t limit) {
+    if (slitherlink == nullptr || !root_consistent) {
+        return 0;
+    }
+    solver_state* root_state = new solver_state;
+    saveState(root_state);
+
+    solution_pending = false;
+    search_finished = false;
+    no_of_solutions = 0;
+    solution_limit = limit;
+    skip_known_solutions = true;
+    while (no_of_solutions < limit && nextSolution() != nullptr) {
+    }
+    std::ptrdiff_t found_solutions = std::min(no_of_solutions, limit);
+
+    // go back to propagated state of edited puzzle
+    clearGuesses();
+    loadState(root_state);
+    delete root_state;
+    solution_pending = false;
+    search_finished = false;
+    no_of_solutions = 0;
+    solution_limit = -1;
+    skip_known_solutions = false;
+    return found_solutions;
+}
+
+bool Solver::editClue(std::ptrdiff_t face_id, std::ptrdiff_t value) {
+    if (slitherlink == nullptr ||
+        face_id < 0 ||
+        face_id >= slitherlink->no_of_faces - 1) {
+        ERROR("Can't edit clue of face ", face_id);
+        return false;
+    }
+    slitherlink_face* face = slitherlink->faces[face_id];
+    if (face->value == value) {
+        return root_consistent;
+    }
+    face->value = value;
+
+    if (root_consistent) {
+        retractDeductions(face_id);
+        root_consistent = rebuildLoops() && propagate();
+    }
+    else {
+        // propagation stopped half way, so nothing is known to be local
+        root_consistent = seedPropagation() && propagate();
+    }
+    if (!root_consistent) {
+        queue.clear();
+    }
+    return root_consistent;
+}
+
+void Solver::retractCausedBy(const std::vector<slitherlink_edge*>& edge_refs,
+                             std::pair<queue_item_type, std::ptrdiff_t> cause,
+                             std::ptrdiff_t order,
+                             std::vector<slitherlink_edge*>* retracted) {
+    for (slitherlink_edge* edge_p : edge_refs) {
+        if (edge_p->solution != EDGE_UNKNOWN &&
+            edge_cause[edge_p->id] == cause &&
+            edge_order[edge_p->id] > order) {
+            setEdgeSolution(edge_p, EDGE_UNKNOWN);
+            retracted->push_back(edge_p);
+        }
+    }
+}
+
+void Solver::retractDeductions(std::ptrdiff_t face_id) {
+    std::vector<slitherlink_edge*> retracted;
+    retractCausedBy(slitherlink->faces[face_id]->edge_refs,
+                    std::make_pair(QUEUE_ITEM_FACE, face_id),
+                    -1,
+                    &retracted);
+
+    // Deduction of face or vertex depends only on its edges known before it
+    for (std::size_t i = 0; i < retracted.size(); ++i) {
+        slitherlink_edge* edge_p = retracted[i];
+        for (std::ptrdiff_t j = 0; j < 2; ++j) {
+            if (edge_p->face_ids[j] != OUTER_FACE) {
+                retractCausedBy(edge_p->face_refs[j]->edge_refs,
+                                std::make_pair(QUEUE_ITEM_FACE, edge_p->face_ids[j]),
+                                edge_order[edge_p->id],
+                                &retracted);
+            }
+            retractCausedBy(edge_p->vertex_refs[j]->edge_refs,
+                            std::make_pair(QUEUE_ITEM_VERTEX, edge_p->vertices[j]),
+                            edge_order[edge_p->id],
+                            &retracted);
+        }
+    }
+    LOG("Clue of face ", face_id, " retracted ", retracted.size(), " edges");
+
+    faces_solved[face_id] = false;
+    queue.push_back(std::make_pair(QUEUE_ITEM_FACE, face_id));
+    for (slitherlink_edge* edge_p : retracted) {
+        for (std::ptrdiff_t j = 0; j < 2; ++j) {
+            if (edge_p->face_ids[j] != OUTER_FACE) {
+                faces_solved[edge_p->face_ids[j]] = false;
+                queue.push_back(std::make_pair(QUEUE_ITEM_FACE, edge_p->face_ids[j]));
+            }
+            vertices_solved[edge_p->vertices[j]] = false;
+            queue.push_back(std::make_pair(QUEUE_ITEM_VERTEX, edge_p->vertices[j]));
+        }
+    }
+}
+
+bool Solver::rebuildLoops() {
+    edge_to_loop_part.assign(slitherlink->no_of_edges, -1);
+    max_loop_part_id = -1;
+    no_of_loop_parts = 0;
+    bool has_closed_loop = false;
+    std::vector<slitherlink_edge*> stack;
+    for (slitherlink_edge* first_edge_p : slitherlink->edges) {
+        if (first_edge_p->solution != EDGE_IN_SOLUTION ||
+            edge_to_loop_part[first_edge_p->id] != -1) {
+            continue;
+        }
+        max_loop_part_id++;
+        no_of_loop_parts++;
+        edge_to_loop_part[first_edge_p->id] = max_loop_part_id;
+        stack.push_back(first_edge_p);
+        bool is_open = false;
+        while (!stack.empty()) {
+            slitherlink_edge* edge_p = stack.back();
+            stack.pop_back();
+            for (slitherlink_vertex* vertex_p : edge_p->vertex_refs) {
+                std::ptrdiff_t edges_in_solution = 0;
+                for (slitherlink_edge* next_edge_p : vertex_p->edge_refs) {
+                    if (next_edge_p->solution != EDGE_IN_SOLUTION) {
+                        continue;
+                    }
+                    edges_in_solution++;
+                    if (edge_to_loop_part[next_edge_p->id] == -1) {
+                        edge_to_loop_part[next_edge_p->id] = max_loop_part_id;
+                        stack.push_back(next_edge_p);
+                    }
+                }
+                if (edges_in_solution > 2) {
+                    return false;
+                }
+                if (edges_in_solution == 1) {
+                    is_open = true;
+                }
+            }
+        }
+        has_closed_loop = has_closed_loop || !is_open;
+    }
+    if (has_closed_loop) {
+        return no_of_loop_parts == 1 && isSolved();
+    }
+    return true;
+}
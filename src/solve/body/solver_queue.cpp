@@ -14,34 +14,21 @@ void Solver::push(std::pair<queue_item_type, std::ptrdiff_t> item) {
 
 void Solver::push_edge(slitherlink_edge* edge_p) {
     std::size_t queue_size = queue.size();
-    if ((edge_p->face_ids[0] != -1) &&
-        (!faces_solved[edge_p->face_ids[0]])) {
-        if (!isFaceSolved(edge_p->face_refs[0])) {
-            LOG("Pushing face ", edge_p->face_ids[0], " to queue from edge ", edge_p->id);
-            queue.push_back(std::make_pair(QUEUE_ITEM_FACE, edge_p->face_ids[0]));
+    // face or vertex completed by this edge is still checked once
+    for (std::ptrdiff_t i = 0; i < 2; ++i) {
+        if ((edge_p->face_ids[i] != -1) &&
+            (!faces_solved[edge_p->face_ids[i]])) {
+            isFaceSolved(edge_p->face_refs[i]);
+            LOG("Pushing face ", edge_p->face_ids[i], " to queue from edge ", edge_p->id);
+            queue.push_back(std::make_pair(QUEUE_ITEM_FACE, edge_p->face_ids[i]));
         }
     }
 
-
-    if ((edge_p->face_ids[1] != -1) &&
-        (!faces_solved[edge_p->face_ids[1]])) {
-        if (!isFaceSolved(edge_p->face_refs[1])) {
-            LOG("Pushing face ", edge_p->face_ids[1], " to queue from edge ", edge_p->id);
-            queue.push_back(std::make_pair(QUEUE_ITEM_FACE, edge_p->face_ids[1]));
-        }
-    }
-
-    if (!vertices_solved[edge_p->vertices[0]]) {
-        if (!isVertexSolved(edge_p->vertex_refs[0])) {
-            LOG("Pushing vertex ", edge_p->vertices[0], " to queue from edge ", edge_p->id);
-            queue.push_back(std::make_pair(QUEUE_ITEM_VERTEX, edge_p->vertices[0]));
-        }
-    }
-
-    if (!vertices_solved[edge_p->vertices[1]]) {
-        if (!isVertexSolved(edge_p->vertex_refs[1])) {
-            LOG("Pushing vertex ", edge_p->vertices[1], " to queue from edge ", edge_p->id);
-            queue.push_back(std::make_pair(QUEUE_ITEM_VERTEX, edge_p->vertices[1]));
+    for (std::ptrdiff_t i = 0; i < 2; ++i) {
+        if (!vertices_solved[edge_p->vertices[i]]) {
+            isVertexSolved(edge_p->vertex_refs[i]);
+            LOG("Pushing vertex ", edge_p->vertices[i], " to queue from edge ", edge_p->id);
+            queue.push_back(std::make_pair(QUEUE_ITEM_VERTEX, edge_p->vertices[i]));
         }
     }
     if(queue.size() == queue_size) {
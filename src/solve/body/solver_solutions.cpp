@@ -0,0 +1,45 @@
+#include "../api/solver.hpp"
+
+Solver::SolutionIterator::SolutionIterator(Solver* solver, Slitherlink* solution) {
+    this->solver = solver;
+    this->solution = solution;
+}
+
+Slitherlink& Solver::SolutionIterator::operator*() const {
+    return *solution;
+}
+
+Slitherlink* Solver::SolutionIterator::operator->() const {
+    return solution;
+}
+
+Solver::SolutionIterator& Solver::SolutionIterator::operator++() {
+    solution = solver->nextSolution();
+    return *this;
+}
+
+bool Solver::SolutionIterator::operator==(const SolutionIterator& other) const {
+    return solution == other.solution;
+}
+
+bool Solver::SolutionIterator::operator!=(const SolutionIterator& other) const {
+    return solution != other.solution;
+}
+
+Solver::SolutionRange::SolutionRange(Solver* solver, Slitherlink* slitherlink) {
+    this->solver = solver;
+    this->slitherlink = slitherlink;
+}
+
+Solver::SolutionIterator Solver::SolutionRange::begin() {
+    solver->startSolving(slitherlink);
+    return SolutionIterator(solver, solver->nextSolution());
+}
+
+Solver::SolutionIterator Solver::SolutionRange::end() {
+    return SolutionIterator(solver, nullptr);
+}
+
+Solver::SolutionRange Solver::solutions(Slitherlink* slitherlink) {
+    return SolutionRange(this, slitherlink);
+}
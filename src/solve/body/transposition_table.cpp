@@ -0,0 +1,76 @@
+#include "../api/transposition_table.hpp"
+
+// Empty entry - value with all bits set is never a number of solutions
+#define ENTRY_EMPTY (~0ULL)
+
+TranspositionTable::TranspositionTable(std::size_t no_of_entries) {
+    this->no_of_entries = 1;
+    while (this->no_of_entries < no_of_entries) {
+        this->no_of_entries <<= 1;
+    }
+    this->mask = this->no_of_entries - 1;
+    this->entries.reset(new table_entry[this->no_of_entries]);
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < no_of_entries; ++i) {
+        entries[i].check.store(0, std::memory_order_relaxed);
+        entries[i].value.store(ENTRY_EMPTY, std::memory_order_relaxed);
+    }
+    no_of_probes.store(0, std::memory_order_relaxed);
+    no_of_hits.store(0, std::memory_order_relaxed);
+    no_of_stores.store(0, std::memory_order_relaxed);
+    no_of_overwrites.store(0, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::probe(std::uint64_t hash, std::ptrdiff_t* no_of_solutions) {
+    no_of_probes.fetch_add(1, std::memory_order_relaxed);
+    table_entry& entry = entries[hash & mask];
+    std::uint64_t value = entry.value.load(std::memory_order_relaxed);
+    std::uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if (value == ENTRY_EMPTY || (check ^ value) != hash) {
+        return false;
+    }
+    no_of_hits.fetch_add(1, std::memory_order_relaxed);
+    *no_of_solutions = (std::ptrdiff_t)value;
+    return true;
+}
+
+void TranspositionTable::store(std::uint64_t hash, std::ptrdiff_t no_of_solutions) {
+    no_of_stores.fetch_add(1, std::memory_order_relaxed);
+    table_entry& entry = entries[hash & mask];
+    std::uint64_t old_value = entry.value.load(std::memory_order_relaxed);
+    if (old_value != ENTRY_EMPTY &&
+        (entry.check.load(std::memory_order_relaxed) ^ old_value) != hash) {
+        no_of_overwrites.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::uint64_t value = (std::uint64_t)no_of_solutions;
+    entry.check.store(hash ^ value, std::memory_order_relaxed);
+    entry.value.store(value, std::memory_order_relaxed);
+}
+
+std::size_t TranspositionTable::getNoOfEntries() const {
+    return no_of_entries;
+}
+
+std::uint64_t TranspositionTable::getNoOfProbes() const {
+    return no_of_probes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TranspositionTable::getNoOfHits() const {
+    return no_of_hits.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TranspositionTable::getNoOfStores() const {
+    return no_of_stores.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TranspositionTable::getNoOfOverwrites() const {
+    return no_of_overwrites.load(std::memory_order_relaxed);
+}
+
+double TranspositionTable::getHitRate() const {
+    std::uint64_t probes = getNoOfProbes();
+    return probes == 0 ? 0.0 : (double)getNoOfHits() / (double)probes;
+}
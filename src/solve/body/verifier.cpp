@@ -0,0 +1,146 @@
+#include "../api/verifier.hpp"
+#include "../../utilities/api/parallel.hpp"
+#include <atomic>
+
+/**
+ * Number of solutions verified by one thread at least.
+ */
+#define VERIFIER_PARALLEL_MIN_CHUNK     (16)
+
+const char* getVerificationName(verification_result result){
+    switch (result) {
+        case VERIFICATION_CORRECT:
+            return "correct";
+        case VERIFICATION_UNKNOWN_EDGE:
+            return "unknown_edge";
+        case VERIFICATION_WRONG_CLUE:
+            return "wrong_clue";
+        case VERIFICATION_WRONG_DEGREE:
+            return "wrong_degree";
+        case VERIFICATION_NO_LOOP:
+            return "no_loop";
+        case VERIFICATION_MANY_LOOPS:
+            return "many_loops";
+    }
+    return "unknown";
+}
+
+/**
+ * Topology is explicit puzzle or implicit grid, clue(face_id) gives clue
+ * of face and is_in_solution(edge_id) gives 1, 0 or -1 for unknown edge.
+ */
+template<typename Topology, typename Clue, typename IsInSolution>
+static verification_result verify(const Topology& topology, Clue clue, IsInSolution is_in_solution){
+    // degrees and clue counts are small, bytes keep arrays in cache
+    auto degrees = topology.template makeVertexArray<std::uint8_t>();
+    // outer face is counted at the last index
+    std::ptrdiff_t no_of_faces = topology.getNoOfFaces();
+    auto face_counts = topology.template makeFaceArray<std::uint8_t>();
+    std::ptrdiff_t no_of_edges = topology.getNoOfEdges();
+    std::ptrdiff_t no_of_in_edges = 0;
+    std::ptrdiff_t first_edge_id = -1;
+    for (std::ptrdiff_t i = 0; i < no_of_edges; ++i) {
+        int state = is_in_solution(i);
+        if (state == -1) {
+            return VERIFICATION_UNKNOWN_EDGE;
+        }
+        if (state == 0) {
+            continue;
+        }
+        first_edge_id = i;
+        no_of_in_edges++;
+        for (int j = 0; j < 2; ++j) {
+            degrees[topology.getEdgeVertex(i, j)]++;
+            std::ptrdiff_t face_id = topology.getEdgeFace(i, j);
+            face_counts[face_id == OUTER_FACE ? no_of_faces : face_id]++;
+        }
+    }
+    for (std::ptrdiff_t i = 0; i < no_of_faces; ++i) {
+        std::ptrdiff_t value = clue(i);
+        if (value != FACE_NO_VALUE && face_counts[i] != value) {
+            return VERIFICATION_WRONG_CLUE;
+        }
+    }
+    for (std::uint8_t degree : degrees) {
+        if (degree != 0 && degree != 2) {
+            return VERIFICATION_WRONG_DEGREE;
+        }
+    }
+    if (no_of_in_edges == 0) {
+        return VERIFICATION_NO_LOOP;
+    }
+    // every vertex has degree 2, so walk from first edge comes back to it
+    std::ptrdiff_t no_of_loop_edges = 0;
+    std::ptrdiff_t edge_id = first_edge_id;
+    std::ptrdiff_t vertex_id = topology.getEdgeVertex(edge_id, 1);
+    do {
+        no_of_loop_edges++;
+        std::ptrdiff_t next_edge_id = edge_id;
+        topology.forEachVertexEdge(vertex_id, [&](std::ptrdiff_t other_edge_id){
+            if (next_edge_id == edge_id && other_edge_id != edge_id && is_in_solution(other_edge_id) == 1) {
+                next_edge_id = other_edge_id;
+            }
+        });
+        edge_id = next_edge_id;
+        vertex_id = topology.getEdgeVertex(edge_id, 0) == vertex_id ? topology.getEdgeVertex(edge_id, 1) :
+                                                                      topology.getEdgeVertex(edge_id, 0);
+    } while (edge_id != first_edge_id);
+    return no_of_loop_edges == no_of_in_edges ? VERIFICATION_CORRECT : VERIFICATION_MANY_LOOPS;
+}
+
+verification_result verifySolution(Slitherlink* slitherlink){
+    return verify(SlitherlinkTopology(slitherlink),
+                  [slitherlink](std::ptrdiff_t face_id){
+                      return slitherlink->faces[face_id]->value;
+                  },
+                  [slitherlink](std::ptrdiff_t edge_id){
+                      slitherlink_edge_type solution = slitherlink->edges[edge_id]->solution;
+                      return solution == EDGE_UNKNOWN ? -1 : solution == EDGE_IN_SOLUTION ? 1 : 0;
+                  });
+}
+
+verification_result verifySolution(Slitherlink* slitherlink, const std::vector<std::uint8_t>& bits){
+    if ((std::ptrdiff_t)bits.size() * 8 < slitherlink->no_of_edges) {
+        return VERIFICATION_UNKNOWN_EDGE;
+    }
+    return verify(SlitherlinkTopology(slitherlink),
+                  [slitherlink](std::ptrdiff_t face_id){
+                      return slitherlink->faces[face_id]->value;
+                  },
+                  [&bits](std::ptrdiff_t edge_id){
+                      return (bits[edge_id / 8] >> (edge_id % 8)) & 1;
+                  });
+}
+
+verification_result verifySolution(const HexTopology& topology,
+                                   const std::vector<std::int8_t>& clues,
+                                   const std::vector<std::uint8_t>& bits){
+    if ((std::ptrdiff_t)clues.size() < topology.getNoOfFaces() ||
+        (std::ptrdiff_t)bits.size() * 8 < topology.getNoOfEdges()) {
+        return VERIFICATION_UNKNOWN_EDGE;
+    }
+    return withHexTopology(topology.getSize(), [&](const auto& sized_topology){
+        return verify(sized_topology,
+                      [&clues](std::ptrdiff_t face_id){
+                          return (std::ptrdiff_t)clues[face_id];
+                      },
+                      [&bits](std::ptrdiff_t edge_id){
+                          return (bits[edge_id / 8] >> (edge_id % 8)) & 1;
+                      });
+    });
+}
+
+std::ptrdiff_t verifySolutions(const std::vector<Slitherlink*>& solutions,
+                               std::vector<verification_result>* results){
+    results->assign(solutions.size(), VERIFICATION_CORRECT);
+    std::atomic<std::ptrdiff_t> no_of_correct(0);
+    parallelFor(solutions.size(), VERIFIER_PARALLEL_MIN_CHUNK, [&](std::ptrdiff_t begin, std::ptrdiff_t end){
+        std::ptrdiff_t no_of_chunk_correct = 0;
+        for (std::ptrdiff_t i = begin; i < end; ++i) {
+            (*results)[i] = verifySolution(solutions[i]);
+            no_of_chunk_correct += (*results)[i] == VERIFICATION_CORRECT;
+        }
+        no_of_correct += no_of_chunk_correct;
+    });
+    return no_of_correct;
+}
@@ -0,0 +1,85 @@
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef BUFFERED_WRITER_H
+#define BUFFERED_WRITER_H
+
+#define BUFFERED_WRITER_CAPACITY    (1 << 20)
+
+/**
+ * Output formatted into reusable buffer with std::to_chars
+ * and written to file descriptor, FILE* or stream in big blocks.
+ * Buffer is flushed when full, on flush() and on destruction.
+ */
+class BufferedWriter {
+    public:
+        BufferedWriter(int fd, std::size_t capacity = BUFFERED_WRITER_CAPACITY);
+
+        BufferedWriter(std::FILE* file, std::size_t capacity = BUFFERED_WRITER_CAPACITY);
+
+        BufferedWriter(std::ostream* ostream, std::size_t capacity = BUFFERED_WRITER_CAPACITY);
+
+        ~BufferedWriter();
+
+        inline void write(const char* data, std::size_t size){
+            if (size > buffer.size() - used) {
+                flush();
+                if (size > buffer.size()) {
+                    writeBlock(data, size);
+                    return;
+                }
+            }
+            std::memcpy(buffer.data() + used, data, size);
+            used += size;
+        }
+
+        inline void write(const char* text){
+            write(text, std::strlen(text));
+        }
+
+        inline void write(const std::string& text){
+            write(text.data(), text.size());
+        }
+
+        inline void write(char character){
+            if (used == buffer.size()) {
+                flush();
+            }
+            buffer[used++] = character;
+        }
+
+        inline void writeNumber(std::ptrdiff_t value){
+            // longest 64 bit number with sign
+            if (buffer.size() - used < 20) {
+                flush();
+            }
+            std::to_chars_result result = std::to_chars(buffer.data() + used,
+                                                        buffer.data() + buffer.size(),
+                                                        value);
+            used = result.ptr - buffer.data();
+        }
+
+        /**
+         * Write buffered data to target and flush target.
+         * @return false if any write failed since construction
+         */
+        bool flush();
+
+        bool isGood();
+
+    private:
+        int fd;
+        std::FILE* file;
+        std::ostream* ostream;
+        std::vector<char> buffer;
+        std::size_t used;
+        bool is_good;
+
+        void writeBlock(const char* data, std::size_t size);
+};
+
+#endif // BUFFERED_WRITER_H
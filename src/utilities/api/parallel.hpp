@@ -0,0 +1,40 @@
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/**
+ * Number of threads worth starting for work of given size,
+ * so that every thread gets at least min_chunk_size of it.
+ */
+inline std::ptrdiff_t getNoOfThreads(std::ptrdiff_t size, std::ptrdiff_t min_chunk_size){
+    std::ptrdiff_t no_of_threads = std::max<std::ptrdiff_t>(1, std::thread::hardware_concurrency());
+    return std::max<std::ptrdiff_t>(1, std::min(no_of_threads, size / std::max<std::ptrdiff_t>(1, min_chunk_size)));
+}
+
+/**
+ * Split range [0, size) into contiguous chunks and call function(begin, end)
+ * for every chunk on separate thread. Small ranges run on calling thread.
+ */
+template<typename Function>
+void parallelFor(std::ptrdiff_t size, std::ptrdiff_t min_chunk_size, Function function){
+    std::ptrdiff_t no_of_threads = getNoOfThreads(size, min_chunk_size);
+    if (no_of_threads == 1) {
+        function((std::ptrdiff_t)0, size);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(no_of_threads - 1);
+    for (std::ptrdiff_t i = 1; i < no_of_threads; ++i) {
+        threads.emplace_back(function, size * i / no_of_threads, size * (i + 1) / no_of_threads);
+    }
+    function((std::ptrdiff_t)0, size / no_of_threads);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+#endif // PARALLEL_H
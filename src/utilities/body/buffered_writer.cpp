@@ -0,0 +1,72 @@
+#include "../api/buffered_writer.hpp"
+#include <cerrno>
+#include <unistd.h>
+
+BufferedWriter::BufferedWriter(int fd, std::size_t capacity){
+    this->fd = fd;
+    this->file = nullptr;
+    this->ostream = nullptr;
+    this->buffer.resize(capacity < 32 ? 32 : capacity);
+    this->used = 0;
+    this->is_good = fd >= 0;
+}
+
+BufferedWriter::BufferedWriter(std::FILE* file, std::size_t capacity)
+    : BufferedWriter(-1, capacity){
+    this->file = file;
+    this->is_good = file != nullptr;
+}
+
+BufferedWriter::BufferedWriter(std::ostream* ostream, std::size_t capacity)
+    : BufferedWriter(-1, capacity){
+    this->ostream = ostream;
+    this->is_good = ostream != nullptr && ostream->good();
+}
+
+BufferedWriter::~BufferedWriter(){
+    flush();
+}
+
+void BufferedWriter::writeBlock(const char* data, std::size_t size){
+    if (!is_good) {
+        return;
+    }
+    if (file != nullptr) {
+        is_good = std::fwrite(data, 1, size, file) == size;
+    }
+    else if (ostream != nullptr) {
+        is_good = (bool)ostream->write(data, size);
+    }
+    else {
+        while (size > 0) {
+            ssize_t no_of_written = ::write(fd, data, size);
+            if (no_of_written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                is_good = false;
+                return;
+            }
+            data += no_of_written;
+            size -= no_of_written;
+        }
+    }
+}
+
+bool BufferedWriter::flush(){
+    if (used > 0) {
+        writeBlock(buffer.data(), used);
+        used = 0;
+    }
+    if (is_good && file != nullptr) {
+        is_good = std::fflush(file) == 0;
+    }
+    else if (is_good && ostream != nullptr) {
+        is_good = (bool)ostream->flush();
+    }
+    return is_good;
+}
+
+bool BufferedWriter::isGood(){
+    return is_good;
+}